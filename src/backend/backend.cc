@@ -5,27 +5,696 @@
 
 #include "backend.h"
 
+#include <algorithm>
+#include <bit>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /// @brief Gets .obj file to be opened and used to fill points and polygons
 /// vectors
 /// @param file A full file path
-void s21::Model::GetFile(const char* file) {
+/// @return True if the file was opened
+bool s21::Model::GetFile(const char* file) {
+  if (BrickFile::IsBrickFile(file)) return OpenBricks(file);
+  file_stamp stamp;
+  bool cached = cache != nullptr && ModelCache::Stamp(file, &stamp);
+  std::string key = cached ? CacheKey(file) : "";
+  cached_model model;
+  if (cached && cache->Find(key.c_str(), stamp, &model))
+    return AdoptCached(model);
   FILE* f = fopen(file, "r");
-  if (f != NULL) {
-    ClearVectors();
-    FillVectors(f);
-    fclose(f);
-    Centrelize();
-    ResetParams();
+  if (f == NULL) return false;
+  bool result = ReadStream(f);
+  fclose(f);
+  if (result && cached)
+    cache->Insert(key.c_str(), stamp,
+                  {GetSnapshot(), source_bounds, position});
+  return result;
+}
+
+/// @brief Takes a model found in the cache, unless it exceeds the memory
+/// limit, which may be lower than the one it was loaded with
+/// @param model A model from the cache
+/// @return False if the model is refused
+bool s21::Model::AdoptCached(const cached_model& model) {
+  size_t bytes = ModelCache::CountBytes(*model.base);
+  stats.expected_bytes = bytes;
+  stats.refused = memory_limit > 0 && bytes > memory_limit;
+  if (stats.refused) return false;
+  Adopt(model);
+  return true;
+}
+
+/// @brief Makes the name a file is cached under: models loaded with other
+/// welding, compact mode or reordering differ, so they are cached apart
+/// @param file A full file path
+/// @return The path followed by the load settings
+std::string s21::Model::CacheKey(const char* file) const {
+  char settings[64];
+  snprintf(settings, sizeof(settings), "\n%.17g %d %d", weld_epsilon,
+           compact ? 1 : 0, reorder ? 1 : 0);
+  return std::string(file) + settings;
+}
+
+/// @brief Parses a file into the cache in advance, so that opening it later
+/// is instant. The file is stored as the least recently used entry and only
+/// if it fits the free part of the budget, which is checked against the
+/// pre-scan estimate before anything is parsed
+/// @param file A full file path
+/// @return True if the file is in the cache afterwards
+bool s21::Model::Prefetch(const char* file) {
+  file_stamp stamp;
+  if (cache == nullptr || !ModelCache::Stamp(file, &stamp)) return false;
+  if (BrickFile::IsBrickFile(file)) return false;
+  std::string key = CacheKey(file);
+  if (cache->Contains(key.c_str(), stamp)) return true;
+  FILE* f = fopen(file, "r");
+  if (f == NULL) return false;
+  obj_counts counts;
+  bool result = ScanStream(f, &counts) && cache->Fits(CountBytes(counts)) &&
+                ReadScanned(f, counts);
+  fclose(f);
+  return result && cache->Insert(key.c_str(), stamp,
+                                 {GetSnapshot(), source_bounds, position},
+                                 false);
+}
+
+/// @brief Fills points and polygons vectors from an opened .obj stream, which
+/// may also be a memory buffer opened with fmemopen. A pre-scan counts the
+/// records first, so the model is refused before anything is changed if it
+/// exceeds the memory limit, and otherwise everything is reserved exactly.
+/// Vertices are welded before centering if welding is on, then faces are
+/// reordered for the vertex cache if reordering is on
+/// @param f An opened stream, it is not closed
+/// @return False if the stream can't be read or the model is too large
+bool s21::Model::ReadStream(FILE* f) {
+  obj_counts counts;
+  if (f == NULL || !ScanStream(f, &counts)) return false;
+  return ReadScanned(f, counts);
+}
+
+/// @brief Fills the vectors from a stream that has already been pre-scanned,
+/// see ReadStream
+/// @param f An opened stream positioned where the scan started
+/// @param counts Counts found by ScanStream
+/// @return False if the model is too large
+bool s21::Model::ReadScanned(FILE* f, const obj_counts& counts) {
+  size_t bytes = CountBytes(counts);
+  bool refused = memory_limit > 0 && bytes > memory_limit;
+  stats.expected_bytes = bytes;
+  stats.refused = refused;
+  if (refused) return false;
+  bricks.reset();
+  resident.clear();
+  std::shared_ptr<FaceList> faces = ClearVectors();
+  FillVectors(f, faces.get(), counts);
+  position.check = ReadCheck(f, position.offset);
+  stats.welded =
+      WeldVertices(points, faces.get(), weld_epsilon, &read_normals);
+  if (stats.welded > 0) {
+    points->shrink_to_fit();
+    // Indices in appended records follow the file's numbering, which no
+    // longer matches the points, so changes are loaded in full
+    position = {-1, ""};
+  }
+  stats.acmr_before = stats.acmr_after = 0;
+  if (reorder) {
+    stats.acmr_before = CountAcmr(*faces, points->size());
+    ReorderMesh(points, faces.get(), &read_normals);
+    stats.acmr_after = CountAcmr(*faces, points->size());
+    // Vertices are renumbered, appended records would refer to old numbers
+    position = {-1, ""};
   }
+  Centrelize();
+  if (compact) Pack();
+  ResetParams();
+  ResetTransform();
+  Publish();
+  return true;
 }
 
-/// @brief Clears points and polygons vectors
-void s21::Model::ClearVectors() {
+/// @brief Quantizes the centered points to 16 bits per coordinate and drops
+/// them. Zoom, rotation and shift then change only the tracked transform,
+/// which Publish combines with the quantization for the readers. Appended
+/// records can't be added to packed positions, so changes are loaded in full
+void s21::Model::Pack() {
+  std::shared_ptr<packed_positions> next =
+      std::make_shared<packed_positions>();
+  vertice min = {0, 0, 0}, max = {0, 0, 0}, current = {0, 0, 0};
+  CountMaxMin(&max, &min, &current);
+  double range = 65535;
+  next->origin = min;
+  next->step = {(max.x - min.x) / range, (max.y - min.y) / range,
+                (max.z - min.z) / range};
+  next->values.resize(points->size() * 3);
+  auto quantize = [range](double value, double origin, double step) {
+    if (step == 0) return (uint16_t)0;
+    double q = round((value - origin) / step);
+    // NaN fails both range checks below, a cast of it is undefined
+    if (!isfinite(q)) return (uint16_t)0;
+    return (uint16_t)(q < 0 ? 0 : q > range ? range : q);
+  };
+  for (size_t i = 0; i < points->size(); ++i) {
+    const vertice& point = (*points)[i];
+    next->values[i * 3] = quantize(point.x, next->origin.x, next->step.x);
+    next->values[i * 3 + 1] = quantize(point.y, next->origin.y, next->step.y);
+    next->values[i * 3 + 2] = quantize(point.z, next->origin.z, next->step.z);
+  }
+  packed = next;
   points->clear();
-  for (size_t main_size = 0; main_size < polygons->size(); ++main_size) {
-    polygons[main_size].clear();
+  points->shrink_to_fit();
+  position = {-1, ""};
+}
+
+/// @brief Counts vertex and face lines and face indices of an .obj stream
+/// without parsing numbers. The stream is read in large blocks, which
+/// ScanLines classifies 16 bytes at a time where SSE2 is available. The
+/// stream is put back where it was
+/// @param f An opened stream
+/// @param counts Destination for the counts
+/// @return False if the stream can't be read or repositioned
+bool s21::Model::ScanStream(FILE* f, obj_counts* counts) {
+  *counts = {0, 0, 0};
+  long start = ftell(f);
+  if (start < 0) return false;
+  std::vector<char> buffer(SCAN_BYTES);
+  size_t kept = 0;
+  size_t read = 0;
+  while ((read = fread(buffer.data() + kept, 1, buffer.size() - kept, f)) >
+         0) {
+    size_t size = kept + read;
+    size_t done = size;
+    while (done > 0 && buffer[done - 1] != '\n') --done;
+    if (done == 0) {
+      // A line longer than the buffer, it is scanned once it is complete
+      kept = size;
+      if (kept == buffer.size()) buffer.resize(buffer.size() * 2);
+      continue;
+    }
+    ScanLines(buffer.data(), done, counts);
+    kept = size - done;
+    memmove(buffer.data(), buffer.data() + done, kept);
   }
-  polygons->clear();
+  // An unfinished last line is skipped by the parser too
+  return !ferror(f) && fseek(f, start, SEEK_SET) == 0;
+}
+
+/// @brief Counts a vertex or face line by its first two characters
+/// @param line Beginning of a line that isn't the last byte of the data
+/// @param counts Counts to be increased
+/// @return True for a face line, whose indices are to be counted
+bool s21::Model::ScanLineStart(const char* line, obj_counts* counts) {
+  if (line[0] == '\n' || line[1] != ' ') return false;
+  if (line[0] == 'v') ++counts->vertices;
+  if (line[0] != 'f') return false;
+  ++counts->faces;
+  return true;
+}
+
+/// @brief Counts records in complete lines, the way ParseLine reads them.
+/// Indices are the space separated words of face lines starting like a
+/// number. With SSE2 every 16 bytes give masks of line breaks and of such
+/// word starts, which are counted up to each break; the rest of the data,
+/// or all of it without SSE2, is read line by line with memchr
+/// @param data Lines, the last one ends with a line break
+/// @param size Size of the data
+/// @param counts Counts to be increased
+void s21::Model::ScanLines(const char* data, size_t size,
+                           obj_counts* counts) {
+  if (size == 0) return;
+  bool face = ScanLineStart(data, counts);
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128i breaks = _mm_set1_epi8('\n');
+  const __m128i spaces = _mm_set1_epi8(' ');
+  const __m128i before_digits = _mm_set1_epi8('0' - 1);
+  const __m128i after_digits = _mm_set1_epi8('9' + 1);
+  const __m128i minus = _mm_set1_epi8('-');
+  const __m128i plus = _mm_set1_epi8('+');
+  for (; i + 16 <= size; i += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+    __m128i number = _mm_or_si128(
+        _mm_and_si128(_mm_cmpgt_epi8(block, before_digits),
+                      _mm_cmplt_epi8(block, after_digits)),
+        _mm_or_si128(_mm_cmpeq_epi8(block, minus),
+                     _mm_cmpeq_epi8(block, plus)));
+    unsigned lines = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, breaks));
+    unsigned space = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, spaces));
+    unsigned words = (unsigned)_mm_movemask_epi8(number) &
+                     ((space << 1) | (i > 0 && data[i - 1] == ' '));
+    while (lines != 0) {
+      int line_end = std::countr_zero(lines);
+      unsigned line = (2u << line_end) - 1;
+      if (face) counts->indices += std::popcount(words & line);
+      words &= ~line;
+      lines &= lines - 1;
+      size_t next = i + line_end + 1;
+      face = next < size && ScanLineStart(data + next, counts);
+    }
+    if (face) counts->indices += std::popcount(words);
+  }
+#endif
+  while (i < size) {
+    const char* line_end = (const char*)memchr(data + i, '\n', size - i);
+    size_t end = line_end == nullptr ? size : line_end - data;
+    for (; face && i < end; ++i) {
+      if (i > 0 && data[i - 1] == ' ' &&
+          ((data[i] >= '0' && data[i] <= '9') || data[i] == '-' ||
+           data[i] == '+'))
+        ++counts->indices;
+    }
+    i = end + 1;
+    face = i < size && ScanLineStart(data + i, counts);
+  }
+}
+
+/// @brief Estimates memory a model takes: its points, the published copy of
+/// them, the faces and the buffers built from them when it is published:
+/// line strips, triangles with their faces and edges, and normals
+/// @param counts Counts found by the pre-scan
+/// @return Size in bytes
+size_t s21::Model::CountBytes(const obj_counts& counts) {
+  // Indices take the narrowest width that holds the largest vertex number
+  size_t width = counts.vertices <= UINT16_MAX   ? 2
+                 : counts.vertices <= UINT32_MAX ? 4
+                                                 : 8;
+  // Faces of n vertices make n - 2 triangles, assuming none is shorter
+  size_t triangles = counts.indices > 2 * counts.faces
+                         ? counts.indices - 2 * counts.faces
+                         : 0;
+  size_t points = counts.vertices * sizeof(vertice) * 2;
+  size_t faces = (counts.faces + 1) * sizeof(size_t) + counts.indices * width;
+  // Outlines are closed and separated by a restart index, 64-bit indices
+  // have no strips
+  size_t strips =
+      width == 8 ? 0 : (counts.indices + 2 * counts.faces) * width;
+  size_t cut = triangles * (3 * width + sizeof(size_t) + sizeof(uint8_t));
+  size_t normals = (counts.faces + counts.vertices) * sizeof(vertice);
+  return points + faces + strips + cut + normals;
+}
+
+/// @brief Opens a brick file made by BrickFile::Build. The file is only
+/// mapped into memory, the model is filled by PageBricks with the bricks that
+/// are on screen and fit the budget
+/// @param file A full file path
+/// @return True if the file was opened
+bool s21::Model::OpenBricks(const char* file) {
+  std::unique_ptr<BrickFile> next = std::make_unique<BrickFile>();
+  if (!next->Open(file)) return false;
+  OpenBricks(std::move(next));
+  return true;
+}
+
+/// @brief Shows an already opened brick file
+/// @param file A brick file, the model owns it afterwards
+void s21::Model::OpenBricks(std::unique_ptr<BrickFile> file) {
+  bricks = std::move(file);
+  resident.clear();
+  ClearVectors();
+  source_bounds = bricks->GetHeader().bounds;
+  frame = source_bounds;
+  position = {-1, ""};
+  ResetParams();
+  ResetTransform();
+  if (!PageBricks()) Publish();
+}
+
+/// @brief Chooses the bricks to hold for the current view: bricks whose
+/// bounding spheres reach the visible square, nearest to its center first,
+/// until the budget is spent, counted with CountBytes like a loaded model.
+/// When the choice differs from the resident bricks, the model is rebuilt
+/// from the mapped file and the pages of the read bricks are given back to
+/// the system
+/// @return True if the geometry was changed
+bool s21::Model::PageBricks() {
+  if (bricks == nullptr) return false;
+  vertice centre = CountCentre(frame);
+  double size = CountSize(frame);
+  if (size == 0) size = 1;
+  double scale = sqrt(transform[0] * transform[0] +
+                      transform[4] * transform[4] +
+                      transform[8] * transform[8]);
+
+  std::vector<std::pair<double, uint32_t>> visible;
+  for (uint32_t i = 0; i < bricks->GetBrickCount(); ++i) {
+    const brick_info& info = bricks->GetBrick(i);
+    if (info.vertex_count == 0) continue;
+    vertice middle = CountCentre(info.bounds);
+    vertice half = {(info.bounds.max.x - info.bounds.min.x) / 2,
+                    (info.bounds.max.y - info.bounds.min.y) / 2,
+                    (info.bounds.max.z - info.bounds.min.z) / 2};
+    double radius =
+        sqrt(half.x * half.x + half.y * half.y + half.z * half.z) / size *
+        scale;
+    vertice at = ApplyTransform({(middle.x - centre.x) / size,
+                                 (middle.y - centre.y) / size,
+                                 (middle.z - centre.z) / size});
+    if (fabs(at.x) - radius > 1 || fabs(at.y) - radius > 1) continue;
+    visible.push_back({at.x * at.x + at.y * at.y, i});
+  }
+  std::sort(visible.begin(), visible.end());
+
+  // The budget holds everything the resident bricks make: the points and
+  // their published copy, the faces and the buffers built when publishing
+  std::vector<uint32_t> chosen;
+  obj_counts used = {0, 0, 0};
+  for (const std::pair<double, uint32_t>& brick : visible) {
+    const brick_info& info = bricks->GetBrick(brick.second);
+    obj_counts next = {used.vertices + info.vertex_count,
+                       used.faces + info.face_count,
+                       used.indices + info.index_count};
+    if (CountBytes(next) > brick_budget) continue;
+    used = next;
+    chosen.push_back(brick.second);
+  }
+  std::sort(chosen.begin(), chosen.end());
+  if (chosen == resident) return false;
+
+  std::shared_ptr<FaceList> faces = ClearVectors();
+  for (uint32_t brick : chosen) {
+    bricks->ReadBrick(brick, points, faces.get());
+    bricks->Release(brick);
+  }
+  // Storage kept from a larger set of bricks would be outside the budget
+  points->shrink_to_fit();
+  faces->shrink_to_fit();
+  for (vertice& point : *points) {
+    point = ApplyTransform({(point.x - centre.x) / size,
+                            (point.y - centre.y) / size,
+                            (point.z - centre.z) / size});
+  }
+  resident = std::move(chosen);
+  Publish();
+  return true;
+}
+
+/// @brief Reads records appended to an .obj file after the place it was
+/// parsed up to, an unfinished last line is left for the next read
+/// @param f An opened file
+/// @param from The place the file was parsed up to
+/// @param tail Destination for the appended records and the new position
+/// @param max_bytes Reading stops at the first line end after this many
+/// bytes, 0 reads everything
+/// @return False if the file was rewritten rather than appended
+bool s21::Model::ReadTail(FILE* f, const parse_position& from, obj_tail* tail,
+                          long long max_bytes) {
+  if (f == NULL || from.offset < 0 || fseek(f, 0, SEEK_END) != 0) return false;
+  if (ftell(f) < from.offset || ReadCheck(f, from.offset) != from.check)
+    return false;
+  fseek(f, from.offset, SEEK_SET);
+  tail->points.clear();
+  tail->polygons.clear();
+  long long offset = from.offset;
+  bool end = false;
+  while (!end && (max_bytes <= 0 || offset - from.offset < max_bytes)) {
+    char* line = FillLine(f, &end);
+    if (!end) {
+      offset += strlen(line);
+      ParseLine(line, &tail->points, &tail->polygons);
+    }
+    free(line);
+  }
+  tail->position = {offset, ReadCheck(f, offset)};
+  return true;
+}
+
+/// @brief Reads the bytes right before an offset, they tell if the parsed part
+/// of a file was left untouched
+/// @param f An opened file
+/// @param offset The place the file was parsed up to
+/// @return Up to CHECK_SIZE bytes
+std::string s21::Model::ReadCheck(FILE* f, long long offset) {
+  long long size = offset < CHECK_SIZE ? offset : CHECK_SIZE;
+  std::string check(size, '\0');
+  if (size > 0 && (fseek(f, offset - size, SEEK_SET) != 0 ||
+                   fread(check.data(), 1, size, f) != (size_t)size))
+    check.clear();
+  return check;
+}
+
+/// @brief Adds appended records to the model, keeping its rotation, shift and
+/// zoom. The bounding box is extended by the new vertices only. When it
+/// outgrows the frame the model was centered and resized for, the current
+/// points are centered and resized again in place
+/// @param tail Records returned by ReadTail for the current position
+/// @param slack 1 keeps the model exactly as a full reload would, larger
+/// values let the bounding box grow up to slack times the frame before the
+/// points are refitted, so a growing scan is refitted only now and then
+/// @return False if the model's parse position is unknown
+bool s21::Model::AppendTail(const obj_tail& tail, double slack) {
+  if (position.offset < 0) return false;
+  size_t old_count = points->size();
+  // Points published so far are shared by the next version unless a refit
+  // moves them
+  size_t kept = old_count;
+  // Strips and triangles skip indices of missing vertices, if the faces
+  // read so far use some of them, they may have come now
+  bool rebuild = !tail.points.empty() && !polygons->IndicesBelow(old_count);
+  if (!tail.points.empty()) {
+    bool empty = points->empty();
+    bounding_box bounds = source_bounds;
+    if (empty) bounds = {tail.points[0], tail.points[0]};
+    for (const vertice& point : tail.points) {
+      bounds.min = {std::min(bounds.min.x, point.x),
+                    std::min(bounds.min.y, point.y),
+                    std::min(bounds.min.z, point.z)};
+      bounds.max = {std::max(bounds.max.x, point.x),
+                    std::max(bounds.max.y, point.y),
+                    std::max(bounds.max.z, point.z)};
+    }
+    source_bounds = bounds;
+    if (empty) {
+      frame = bounds;
+    } else if (!FitsFrame(bounds, slack)) {
+      Refit(bounds);
+      kept = 0;
+    }
+
+    vertice centre = CountCentre(frame);
+    double size = CountSize(frame);
+    if (size == 0) size = 1;
+    for (vertice point : tail.points) {
+      point = {(point.x - centre.x) / size, (point.y - centre.y) / size,
+               (point.z - centre.z) / size};
+      points->push_back(ApplyTransform(point));
+    }
+  }
+  if (!tail.polygons.empty()) {
+    // The copy shares the arrays, only the appended faces are written
+    std::shared_ptr<FaceList> faces = std::make_shared<FaceList>(*polygons);
+    faces->Append(tail.polygons);
+    polygons = faces;
+  }
+  if (rebuild) {
+    strips.reset();
+    triangles.reset();
+    normals.reset();
+    normal_sums.clear();
+  }
+  position = tail.position;
+  Publish(kept);
+  return true;
+}
+
+/// @brief Checks if a bounding box still fits the frame the points were
+/// centered and resized for
+/// @param bounds Current bounding box
+/// @param slack How many times the box may outgrow the frame, 1 means it
+/// must be the frame itself
+/// @return True if no refit is needed
+bool s21::Model::FitsFrame(const bounding_box& bounds, double slack) {
+  if (slack <= 1)
+    return bounds.min.x == frame.min.x && bounds.min.y == frame.min.y &&
+           bounds.min.z == frame.min.z && bounds.max.x == frame.max.x &&
+           bounds.max.y == frame.max.y && bounds.max.z == frame.max.z;
+  vertice centre = CountCentre(frame);
+  double half = CountSize(frame) * slack / 2;
+  return bounds.min.x >= centre.x - half && bounds.max.x <= centre.x + half &&
+         bounds.min.y >= centre.y - half && bounds.max.y <= centre.y + half &&
+         bounds.min.z >= centre.z - half && bounds.max.z <= centre.z + half;
+}
+
+/// @brief Centers and resizes the current points for a new frame in one
+/// affine pass, without undoing the zoom, rotation and shift
+/// @param bounds The new frame
+void s21::Model::Refit(const bounding_box& bounds) {
+  vertice old_centre = CountCentre(frame);
+  vertice centre = CountCentre(bounds);
+  double old_size = CountSize(frame);
+  double size = CountSize(bounds);
+  if (old_size == 0) old_size = 1;
+  if (size == 0) size = 1;
+  frame = bounds;
+
+  // centered = (source - centre) / size, so the old centered points are
+  // scaled by old_size / size and moved by (old_centre - centre) / size,
+  // both before the current transform
+  double scale = old_size / size;
+  vertice move = {(old_centre.x - centre.x) / size,
+                  (old_centre.y - centre.y) / size,
+                  (old_centre.z - centre.z) / size};
+  vertice shift = {transform[3], transform[7], transform[11]};
+  vertice offset = ApplyTransform(move);
+  offset = {offset.x - shift.x * scale, offset.y - shift.y * scale,
+            offset.z - shift.z * scale};
+  for (vertice& point : *points) {
+    point.x = point.x * scale + offset.x;
+    point.y = point.y * scale + offset.y;
+    point.z = point.z * scale + offset.z;
+  }
+  // Areas kept for normals are in the centered space, which was scaled
+  for (vertice& sum : normal_sums)
+    sum = {sum.x * scale * scale, sum.y * scale * scale,
+           sum.z * scale * scale};
+}
+
+/// @brief Replaces the model with a freshly loaded version of the same file
+/// and applies the current zoom, rotation and shift to it again. The tracked
+/// transform is applied as a whole, as rotations and shifts made in turns
+/// don't add up per axis. Packed models only need the transform back
+/// @param model The new version right after loading
+/// @param paged The new version's brick file if it is one, the model is then
+/// paged from it rather than taken as is
+void s21::Model::Reload(const cached_model& model,
+                        std::unique_ptr<BrickFile> paged) {
+  double zoom = current_zoom;
+  vertice shift = current_coord_shift;
+  vertice angles = current_coord_angles;
+  double kept[12];
+  std::copy(transform, transform + 12, kept);
+  if (paged != nullptr)
+    OpenBricks(std::move(paged));
+  else
+    Adopt(model);
+  current_zoom = zoom;
+  current_coord_shift = shift;
+  current_coord_angles = angles;
+  std::copy(kept, kept + 12, transform);
+  for (vertice& point : *points) point = ApplyTransform(point);
+  if (!PageBricks()) Publish();
+}
+
+/// @brief Clears points and polygons. The published version is withdrawn
+/// first, so no reader can take the faces any more. If nobody else holds them,
+/// they are cleared with one call and keep their capacity, otherwise they are
+/// left to their readers and new ones are started. A model stored in the
+/// cache is one of them: the cache keeps its faces, so with caching on only
+/// models that weren't cached, such as the ones too large for it, are reused
+/// @return The emptied faces, which the caller fills
+std::shared_ptr<s21::FaceList> s21::Model::ClearVectors() {
+  points->clear();
+  packed.reset();
+  strips.reset();
+  triangles.reset();
+  normals.reset();
+  normal_sums.clear();
+  read_normals.clear();
+  std::shared_ptr<geometry> empty = std::make_shared<geometry>();
+  empty->polygons = std::make_shared<FaceList>();
+  snapshot.store(std::move(empty), std::memory_order_release);
+
+  std::shared_ptr<FaceList> faces;
+  stats.reused = polygons.use_count() == 1;
+  if (stats.reused) {
+    // use_count is a relaxed load, the fence orders the reuse after the
+    // last reader's release of its reference, so its reads are finished
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Every list is created non-const, only handed out as const
+    faces = std::const_pointer_cast<FaceList>(polygons);
+    faces->clear();
+  } else {
+    faces = std::make_shared<FaceList>();
+  }
+  polygons = faces;
+  return faces;
+}
+
+/// @brief Publishes the current points and polygons as a new immutable
+/// version, readers holding older versions keep them until they let go. Line
+/// strips, triangles and normals are built once for new faces and shared by
+/// the next versions. They only depend on the shape of faces, which zoom,
+/// rotation, shift and packing don't change; normals are kept unrotated and
+/// every version carries the rotation for them. Faces appended since they
+/// were built are added to them, the earlier faces are not built again, and
+/// the new arrays share the old ones' storage. Points are shared the same
+/// way when the caller knows the published ones are unchanged
+/// @param kept Number of leading points that haven't changed since the
+/// last publication, 0 publishes all points anew
+void s21::Model::Publish(size_t kept) {
+  bool append = triangles && built_faces < polygons->size();
+  if (!strips || append)
+    strips = BuildLineStrips(*polygons, GetVertexCount(),
+                             append ? strips.get() : nullptr, built_faces);
+  std::shared_ptr<geometry> next = std::make_shared<geometry>();
+  geometry_snapshot last = snapshot.load(std::memory_order_relaxed);
+  if (kept > 0 && last && last->points.size() == kept) {
+    next->points = last->points;
+    next->points.append(points->data() + kept, points->size() - kept);
+  } else {
+    next->points.append(points->data(), points->size());
+  }
+  next->polygons = polygons;
+  next->packed = packed;
+  next->line_strips = strips;
+  if (packed) {
+    // drawn = transform * (origin + step * value)
+    const double step[3] = {packed->step.x, packed->step.y, packed->step.z};
+    vertice origin = ApplyTransform(packed->origin);
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col)
+        next->packed_transform[row * 4 + col] =
+            transform[row * 4 + col] * step[col];
+    }
+    next->packed_transform[3] = origin.x;
+    next->packed_transform[7] = origin.y;
+    next->packed_transform[11] = origin.z;
+  }
+  if (!triangles || append)
+    triangles =
+        Triangulate(*next, 0, append ? triangles.get() : nullptr, built_faces);
+  next->triangles = triangles;
+  if (!normals)
+    normals = ComputeNormals(*next, transform, read_normals);
+  else if (append)
+    normals = AppendNormals(*next, transform, read_normals, *normals,
+                            built_faces, &normal_sums);
+  next->normals = normals;
+  built_faces = polygons->size();
+  // The transform is a rotation times a uniform zoom
+  double scale = sqrt(transform[0] * transform[0] +
+                      transform[4] * transform[4] +
+                      transform[8] * transform[8]);
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 3; ++col)
+      next->normal_rotation[row * 3 + col] =
+          scale == 0 ? row == col : transform[row * 4 + col] / scale;
+  }
+  snapshot.store(std::move(next), std::memory_order_release);
+}
+
+/// @brief Replaces the model with a cached one, which is published as is,
+/// because it is already an immutable untransformed version
+/// @param model A model from the cache
+void s21::Model::Adopt(const cached_model& model) {
+  bricks.reset();
+  resident.clear();
+  points->assign(model.base->points.begin(), model.base->points.end());
+  polygons = model.base->polygons;
+  packed = model.base->packed;
+  strips = model.base->line_strips;
+  triangles = model.base->triangles;
+  normals = model.base->normals;
+  built_faces = polygons->size();
+  normal_sums.clear();
+  read_normals.clear();
+  source_bounds = model.source_bounds;
+  frame = source_bounds;
+  position = model.position;
+  ResetParams();
+  ResetTransform();
+  snapshot.store(model.base, std::memory_order_release);
 }
 
 /// @brief Resets rotation, shift and zoom parameters to default values when new
@@ -37,16 +706,37 @@ void s21::Model::ResetParams() {
 }
 
 /// @brief Gets lines one by one from a file and uses them to fill points and
-/// polygons vectors
+/// polygons vectors, counting allocations made for them
 /// @param f An opened .obj file
-void s21::Model::FillVectors(FILE* f) {
+/// @param faces Emptied faces returned by ClearVectors
+/// @param counts Sizes found by the pre-scan, they are reserved up front
+void s21::Model::FillVectors(FILE* f, FaceList* faces,
+                             const obj_counts& counts) {
   bool end = false;
+  size_t point_allocations = 0;
+  if (counts.vertices > points->capacity()) {
+    points->reserve(counts.vertices);
+    ++point_allocations;
+  }
+  faces->reserve(counts.faces, counts.indices, counts.vertices);
+
+  long long offset = 0;
+  obj_normals normals;
 
   while (!end) {
     char* line = FillLine(f, &end);
-    if (!end) ParseLine(line);
+    if (!end) {
+      offset += strlen(line);
+      size_t capacity = points->capacity();
+      ParseLine(line, points, faces, &normals);
+      if (points->capacity() != capacity) ++point_allocations;
+    }
     free(line);
   }
+  position = {offset, ""};
+  read_normals = std::move(normals.sums);
+  if (!read_normals.empty()) read_normals.resize(points->size());
+  stats.allocations = point_allocations + faces->GetAllocations();
 }
 
 /// @brief Gets one line from a file
@@ -71,11 +761,17 @@ char* s21::Model::FillLine(FILE* f, bool* end) {
 
 /// @brief Parses one line to fill an appropriate (points or polygons) vector
 /// @param line A line to be parsed in form of char*
-void s21::Model::ParseLine(char* line) {
+/// @param vertices Points vector being filled
+/// @param faces Polygons vector being filled
+/// @param normals Normals being filled from vn records and the v/vt/vn face
+/// corners using them, null if they are not read
+void s21::Model::ParseLine(char* line, std::vector<vertice>* vertices,
+                           FaceList* faces, obj_normals* normals) {
   if (strlen(line) < 2) return;
   if (line[0] == 'v' && line[1] == ' ') {
     line[0] = ' ';
-    char* part_spaces = strtok(line, " ");
+    char* save_ptr = nullptr;
+    char* part_spaces = strtok_r(line, " ", &save_ptr);
     int curr_coord = 1;
     vertice point = {0, 0, 0};
     while (part_spaces != nullptr && curr_coord <= 3) {
@@ -86,22 +782,44 @@ void s21::Model::ParseLine(char* line) {
       else if (curr_coord == 3)
         point.z = atof(part_spaces);
       ++curr_coord;
-      part_spaces = strtok(nullptr, " ");
+      part_spaces = strtok_r(nullptr, " ", &save_ptr);
     }
-    points->push_back(point);
+    vertices->push_back(point);
   } else if (line[0] == 'f' && line[1] == ' ') {
     line[0] = ' ';
-    char* part_spaces = strtok(line, " ");
-    std::vector<int> loop;
+    char* save_ptr = nullptr;
+    char* part_spaces = strtok_r(line, " ", &save_ptr);
     while (part_spaces != nullptr) {
-      int to_push = atoi(part_spaces);
-      if (to_push != 0) loop.push_back(to_push - 1);
-      part_spaces = strtok(nullptr, " ");
+      long long to_push = atoll(part_spaces);
+      if (to_push != 0) faces->AddIndex(to_push - 1);
+      if (normals != nullptr && to_push > 0) AddNormal(part_spaces, normals);
+      part_spaces = strtok_r(nullptr, " ", &save_ptr);
     }
-    polygons->push_back(loop);
+    faces->CloseFace();
+  } else if (normals != nullptr && line[0] == 'v' && line[1] == 'n') {
+    vertice normal = {0, 0, 0};
+    sscanf(line + 2, "%lf %lf %lf", &normal.x, &normal.y, &normal.z);
+    normals->records.push_back(normal);
   }
 }
 
+/// @brief Adds the vn record of a v/vt/vn face corner to its vertex
+/// @param corner The corner's text
+/// @param normals Records read so far and the sums being filled
+void s21::Model::AddNormal(const char* corner, obj_normals* normals) {
+  const char* slash = strchr(corner, '/');
+  if (slash != nullptr) slash = strchr(slash + 1, '/');
+  if (slash == nullptr) return;
+  long long record = atoll(slash + 1);
+  if (record < 1 || (size_t)record > normals->records.size()) return;
+  size_t vertex = (size_t)atoll(corner) - 1;
+  if (vertex >= normals->sums.size()) normals->sums.resize(vertex + 1);
+  const vertice& normal = normals->records[record - 1];
+  normals->sums[vertex].x += normal.x;
+  normals->sums[vertex].y += normal.y;
+  normals->sums[vertex].z += normal.z;
+}
+
 /// @brief Moves all points of a model to a center and resizes them to [-0.5;
 /// 0.5] diapason
 void s21::Model::Centrelize() {
@@ -110,6 +828,8 @@ void s21::Model::Centrelize() {
   vertice current = {0, 0, 0};
 
   CountMaxMin(&max, &min, &current);
+  source_bounds = {min, max};
+  frame = source_bounds;
 
   for (size_t size = 0; size < points->size(); ++size) {
     current = (*points)[size];
@@ -166,6 +886,7 @@ void s21::Model::Zoom(double delta) {
     current.z *= delta;
     (*points)[size] = current;
   }
+  for (double& value : transform) value *= delta;
 }
 
 /// @brief Counts delta number and calls Zoom function
@@ -178,6 +899,7 @@ void s21::Model::ZoomValue(int value) {
   double delta = (current_zoom + value) / current_zoom;
   Zoom(delta);
   current_zoom += value;
+  Publish();
 }
 
 /// @brief Counts shift value and call Shift function for X coordinate
@@ -189,6 +911,7 @@ void s21::Model::ShiftXValue(double value) {
     value = Constants::MIN_SHIFT - current_coord_shift.x;
   Shift('x', value);
   current_coord_shift.x += value;
+  Publish();
 }
 
 /// @brief Counts shift value and call Shift function for Y coordinate
@@ -200,6 +923,7 @@ void s21::Model::ShiftYValue(double value) {
     value = Constants::MIN_SHIFT - current_coord_shift.y;
   Shift('y', value);
   current_coord_shift.y += value;
+  Publish();
 }
 
 /// @brief Counts shift value and call Shift function for Z coordinate
@@ -211,6 +935,7 @@ void s21::Model::ShiftZValue(double value) {
     value = Constants::MIN_SHIFT - current_coord_shift.z;
   Shift('z', value);
   current_coord_shift.z += value;
+  Publish();
 }
 
 /// @brief Shifts all model's points with a value by an approptiate coordinate
@@ -232,6 +957,7 @@ void s21::Model::Shift(char coord, double value) {
     }
     (*points)[size] = current;
   }
+  transform[(coord - 'x') * 4 + 3] += value;
 }
 
 /// @brief Rotates a model around Z axis
@@ -251,6 +977,7 @@ void s21::Model::RotateZ(bool plus, int angle) {
     (*points)[size] = point;
   }
 
+  RotateTransform(0, 1, delta_angle);
   delta_angle /= Constants::CONVERT_RAD;
 
   current_coord_angles.z += delta_angle;
@@ -273,6 +1000,7 @@ void s21::Model::RotateY(bool plus, int angle) {
     (*points)[size] = point;
   }
 
+  RotateTransform(2, 0, delta_angle);
   delta_angle /= Constants::CONVERT_RAD;
 
   current_coord_angles.y += delta_angle;
@@ -295,11 +1023,60 @@ void s21::Model::RotateX(bool plus, int angle) {
     (*points)[size] = point;
   }
 
+  RotateTransform(1, 2, delta_angle);
   delta_angle /= Constants::CONVERT_RAD;
 
   current_coord_angles.x += delta_angle;
 }
 
+/// @brief Sets the tracked transform to identity, the points are centered and
+/// resized but not zoomed, rotated or shifted
+void s21::Model::ResetTransform() {
+  for (int i = 0; i < 12; ++i) transform[i] = i % 5 == 0 ? 1 : 0;
+}
+
+/// @brief Applies a rotation to the tracked transform: row_a becomes
+/// row_a * cos - row_b * sin and row_b becomes row_a * sin + row_b * cos
+/// @param row_a First row of the rotation plane
+/// @param row_b Second row of the rotation plane
+/// @param angle Angle in radians
+void s21::Model::RotateTransform(int row_a, int row_b, double angle) {
+  for (int col = 0; col < 4; ++col) {
+    double a = transform[row_a * 4 + col], b = transform[row_b * 4 + col];
+    transform[row_a * 4 + col] = a * cos(angle) - b * sin(angle);
+    transform[row_b * 4 + col] = a * sin(angle) + b * cos(angle);
+  }
+}
+
+/// @brief Applies the tracked transform to a centered point
+/// @param point A centered and resized point
+/// @return The point as it would be after all zooms, rotations and shifts
+s21::vertice s21::Model::ApplyTransform(vertice point) {
+  const double* m = transform;
+  return {m[0] * point.x + m[1] * point.y + m[2] * point.z + m[3],
+          m[4] * point.x + m[5] * point.y + m[6] * point.z + m[7],
+          m[8] * point.x + m[9] * point.y + m[10] * point.z + m[11]};
+}
+
+/// @brief Finds the center of a bounding box
+/// @param box A bounding box
+/// @return Its center, which Centrelize moves to the origin
+s21::vertice s21::Model::CountCentre(const bounding_box& box) {
+  return {box.min.x + (box.max.x - box.min.x) / 2,
+          box.min.y + (box.max.y - box.min.y) / 2,
+          box.min.z + (box.max.z - box.min.z) / 2};
+}
+
+/// @brief Finds the largest side of a bounding box
+/// @param box A bounding box
+/// @return The side Centrelize divides coordinates by
+double s21::Model::CountSize(const bounding_box& box) {
+  double size = box.max.x - box.min.x;
+  if (box.max.y - box.min.y > size) size = box.max.y - box.min.y;
+  if (box.max.z - box.min.z > size) size = box.max.z - box.min.z;
+  return size;
+}
+
 /// @brief Counts an angle to be used in Rotate functions
 /// @param plus True if the angle is positive, otherwise - false
 /// @param angle A value got from the user interface
@@ -329,6 +1106,7 @@ void s21::Model::RotateXAngle(int angle) {
   bool plus = true;
   if (angle < 0) plus = false;
   RotateX(plus, angle);
+  Publish();
 }
 
 /// @brief Gets a changed angle from the user interface and gives it to RotateY
@@ -338,6 +1116,7 @@ void s21::Model::RotateYAngle(int angle) {
   bool plus = true;
   if (angle < 0) plus = false;
   RotateY(plus, angle);
+  Publish();
 }
 
 /// @brief Gets a changed angle from the user interface and gives it to RotateZ
@@ -347,6 +1126,7 @@ void s21::Model::RotateZAngle(int angle) {
   bool plus = true;
   if (angle < 0) plus = false;
   RotateZ(plus, angle);
+  Publish();
 }
 
 /// @brief Changes the param that shows current projection mode
@@ -413,14 +1193,25 @@ void s21::Model::ChangeLineShape() {
     lines_shape = 0;
 }
 
+/// @brief Changes the param that shows current faces shape
+void s21::Model::ChangeFaceShape() {
+  if (faces_shape < 2)
+    faces_shape++;
+  else
+    faces_shape = 0;
+}
+
+/// @brief Changes the param that shows if lines behind faces are removed
+void s21::Model::ChangeHiddenLines() { hidden_lines = !hidden_lines; }
+
 /// @brief Saves all color, shape, size and projection settings to a file to be
 /// used in the next session
 void s21::Model::SaveSettings() {
   FILE* f = fopen("prefs.txt", "w");
   if (f != NULL) {
-    fprintf(f, "%d %d %d %d %d %f %f %d", projection_mode, points_color,
-            lines_color, background_color, lines_shape, lines_width,
-            points_size, points_shape);
+    fprintf(f, "%d %d %d %d %d %f %f %d %d %d", projection_mode,
+            points_color, lines_color, background_color, lines_shape,
+            lines_width, points_size, points_shape, faces_shape, hidden_lines);
     fclose(f);
   }
 }
@@ -430,9 +1221,11 @@ void s21::Model::SaveSettings() {
 void s21::Model::LoadSettings() {
   FILE* f = fopen("prefs.txt", "r");
   if (f != NULL) {
-    fscanf(f, "%d %d %d %d %d %f %f %d", &projection_mode, &points_color,
-           &lines_color, &background_color, &lines_shape, &lines_width,
-           &points_size, &points_shape);
+    // Files saved by older versions end before faces_shape or hidden_lines
+    fscanf(f, "%d %d %d %d %d %f %f %d %d %d", &projection_mode,
+           &points_color, &lines_color, &background_color, &lines_shape,
+           &lines_width, &points_size, &points_shape, &faces_shape,
+           &hidden_lines);
     fclose(f);
   }
 }
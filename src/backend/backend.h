@@ -6,25 +6,88 @@
 #ifndef BACKEND_H
 #define BACKEND_H
 
+#include <stdio.h>
 #include <string.h>
 
+#include <atomic>
 #include <iostream>
+#include <memory>
 #include <vector>
 
+#include "brick_file.h"
 #include "constants.h"
 #include "controller.h"
+#include "line_strips.h"
+#include "model_cache.h"
+#include "normals.h"
+#include "triangulation.h"
+#include "vertex_cache.h"
+#include "welding.h"
 
 namespace s21 {
+/// @brief Sizes of an .obj file found by the pre-scan
+typedef struct {
+  size_t vertices;
+  size_t faces;
+  /// Vertex indices of all faces
+  size_t indices;
+} obj_counts;
+
+/// @brief Normals given by vn records of an .obj file
+typedef struct {
+  /// vn records in file order
+  std::vector<vertice> records;
+  /// Sum of the records given to every vertex by face corners, by vertex
+  std::vector<vertice> sums;
+} obj_normals;
+
 /** @brief Model class is responsible for all business logic, contains the
  * oroginal data */
 class Model {
  private:
   std::vector<vertice>* points;
-  std::vector<std::vector<int>>* polygons;
+  std::shared_ptr<const FaceList> polygons;
+  /// Positions of a model loaded in compact mode, points is empty then
+  std::shared_ptr<const packed_positions> packed;
+  /// Line strips of the current polygons, built by Publish when missing
+  std::shared_ptr<const index_stream> strips;
+  /// Triangles of the current polygons, built by Publish when missing
+  std::shared_ptr<const triangle_list> triangles;
+  /// Normals of the current polygons, built by Publish when missing
+  std::shared_ptr<const normal_list> normals;
+  /// Number of faces strips, triangles and normals were built for, faces
+  /// appended after them are added on the next publication
+  size_t built_faces;
+  /// Area sums of normals by vertex kept for appended faces, see
+  /// AppendNormals
+  std::vector<vertice> normal_sums;
+  /// Sums of vn records by vertex, empty if the file has none
+  std::vector<vertice> read_normals;
+  std::atomic<geometry_snapshot> snapshot;
+  load_stats stats;
   double current_zoom;
   vertice current_coord_shift;
   vertice current_coord_angles;
   int projection_mode;
+  bool persist_settings;
+  ModelCache* cache;
+  size_t memory_limit;
+  /// Welding distance, negative if welding is off
+  double weld_epsilon;
+  bool compact;
+  /// True if faces and vertices are reordered for the vertex cache
+  bool reorder;
+  /// Opened brick file, the model then holds only the resident bricks
+  std::unique_ptr<BrickFile> bricks;
+  /// Numbers of the bricks currently in points and polygons, sorted
+  std::vector<uint32_t> resident;
+  size_t brick_budget;
+  bounding_box source_bounds;
+  /// Bounding box the points were centered and resized for
+  bounding_box frame;
+  /// Affine transform (3x4, row-major) applied to the centered points so far
+  double transform[12];
+  parse_position position;
 
   int lines_color;
   int points_color;
@@ -33,12 +96,32 @@ class Model {
   float lines_width;
   float points_size;
   int points_shape;
-
-  char* FillLine(FILE* f, bool* end);
-  void ParseLine(char* line);
+  int faces_shape;
+  int hidden_lines;
+
+  static char* FillLine(FILE* f, bool* end);
+  static void ParseLine(char* line, std::vector<vertice>* vertices,
+                        FaceList* faces, obj_normals* normals = nullptr);
+  static void AddNormal(const char* corner, obj_normals* normals);
+  static std::string ReadCheck(FILE* f, long long offset);
+  static bool ScanLineStart(const char* line, obj_counts* counts);
+  static void ScanLines(const char* data, size_t size, obj_counts* counts);
   void Centrelize();
-  void FillVectors(FILE* f);
-  void ClearVectors();
+  void FillVectors(FILE* f, FaceList* faces, const obj_counts& counts);
+  bool ReadScanned(FILE* f, const obj_counts& counts);
+  std::shared_ptr<FaceList> ClearVectors();
+  void Publish(size_t kept = 0);
+  void Pack();
+  void Adopt(const cached_model& model);
+  bool AdoptCached(const cached_model& model);
+  std::string CacheKey(const char* file) const;
+  void ResetTransform();
+  void RotateTransform(int row_a, int row_b, double angle);
+  vertice ApplyTransform(vertice point);
+  static vertice CountCentre(const bounding_box& box);
+  static double CountSize(const bounding_box& box);
+  bool FitsFrame(const bounding_box& bounds, double slack);
+  void Refit(const bounding_box& bounds);
 
   void CountMaxMin(vertice* max, vertice* min, vertice* current);
 
@@ -52,29 +135,123 @@ class Model {
   void RotateX(bool plus, int angle);
 
  public:
-  Model()
-      : current_zoom((Constants::MAX_ZOOM - Constants::MIN_ZOOM) / 4 + 1),
+  /// @brief Creates an empty model
+  /// @param persist If true, view settings are loaded from and saved to the
+  /// prefs.txt file, independent models used by background threads pass false
+  explicit Model(bool persist = true)
+      : built_faces(0),
+        current_zoom((Constants::MAX_ZOOM - Constants::MIN_ZOOM) / 4 + 1),
         projection_mode(0),
+        persist_settings(persist),
+        cache(nullptr),
+        memory_limit(0),
+        weld_epsilon(-1),
+        compact(false),
+        reorder(false),
+        brick_budget(BrickFile::DEFAULT_BUDGET),
         lines_color(0),
         points_color(0),
         background_color(0),
         lines_shape(0),
         lines_width(1),
         points_size(1),
-        points_shape(2) {
+        points_shape(2),
+        faces_shape(0),
+        hidden_lines(0) {
     current_coord_shift = {0, 0, 0};
     current_coord_angles = {0, 0, 0};
+    stats = {0, false, 0, false, 0, 0, 0};
+    source_bounds = {{0, 0, 0}, {0, 0, 0}};
+    frame = source_bounds;
+    position = {0, ""};
+    ResetTransform();
     points = new std::vector<vertice>;
-    polygons = new std::vector<std::vector<int>>;
-    LoadSettings();
+    polygons = std::make_shared<FaceList>();
+    Publish();
+    if (persist_settings) LoadSettings();
   };
   ~Model() {
     ClearVectors();
-    SaveSettings();
+    if (persist_settings) SaveSettings();
     delete points;
-    delete polygons;
   }
-  void GetFile(const char* file);
+  bool GetFile(const char* file);
+  bool ReadStream(FILE* f);
+  bool Prefetch(const char* file);
+  bool OpenBricks(const char* file);
+  void OpenBricks(std::unique_ptr<BrickFile> file);
+  bool PageBricks();
+
+  /// @brief Sets how much memory the resident bricks of a brick file may take
+  /// @param bytes Budget in bytes
+  void SetBrickBudget(size_t bytes) { brick_budget = bytes; }
+
+  /// @brief Returns the numbers of the bricks currently held by the model
+  /// @return Sorted brick numbers, empty unless a brick file is opened
+  const std::vector<uint32_t>& GetResidentBricks() { return resident; }
+
+  /// @brief Hands the opened brick file over to another model
+  /// @return The brick file, nullptr if an .obj file is opened
+  std::unique_ptr<BrickFile> TakeBricks() {
+    resident.clear();
+    return std::move(bricks);
+  }
+
+  static constexpr int CHECK_SIZE = 256;
+  /// Amount of text the pre-scan reads at once
+  static constexpr size_t SCAN_BYTES = 1 << 20;
+  static bool ScanStream(FILE* f, obj_counts* counts);
+  static size_t CountBytes(const obj_counts& counts);
+
+  /// @brief Sets the largest model ReadStream may load
+  /// @param bytes Limit in bytes, 0 means no limit
+  void SetMemoryLimit(size_t bytes) { memory_limit = bytes; }
+
+  /// @brief Makes ReadStream merge equal or close vertices
+  /// @param epsilon Largest distance between merged vertices, 0 merges equal
+  /// ones only, a negative value turns welding off
+  void SetWelding(double epsilon) { weld_epsilon = epsilon; }
+
+  /// @brief Makes ReadStream keep positions quantized to 16 bits
+  /// @param enabled True to turn compact mode on
+  void SetCompact(bool enabled) { compact = enabled; }
+
+  /// @brief Makes ReadStream reorder faces and vertices for the vertex cache
+  /// @param enabled True to turn reordering on
+  void SetReordering(bool enabled) { reorder = enabled; }
+
+  /// @brief Makes the model load files the way another one does
+  /// @param other A model to take the memory limit, welding, compact mode,
+  /// reordering and brick budget from
+  void CopyLoadSettings(const Model& other) {
+    memory_limit = other.memory_limit;
+    weld_epsilon = other.weld_epsilon;
+    compact = other.compact;
+    reorder = other.reorder;
+    brick_budget = other.brick_budget;
+  }
+
+  /// @brief Returns the number of vertices, packed or not
+  /// @return Number of vertices
+  size_t GetVertexCount() {
+    return packed ? packed->values.size() / 3 : points->size();
+  }
+
+  static bool ReadTail(FILE* f, const parse_position& from, obj_tail* tail,
+                       long long max_bytes = 0);
+  bool AppendTail(const obj_tail& tail, double slack = 1);
+  void Reload(const cached_model& model,
+              std::unique_ptr<BrickFile> paged = nullptr);
+
+  /// @brief Returns the place up to which the file was parsed
+  /// @return Parse position, the offset is -1 if it is unknown
+  parse_position GetParsePosition() { return position; }
+
+  /// @brief Makes GetFile look models up in a cache and add them to it. The
+  /// cache shares the faces of the models it holds, so ClearVectors can't
+  /// reuse them for the next load
+  /// @param src A cache shared with other models, nullptr disables caching
+  void SetCache(ModelCache* src) { cache = src; }
 
   void ResetParams();
 
@@ -90,13 +267,29 @@ class Model {
 
   void ChangeProjection();
 
-  /// @brief Returns original points vector
+  /// @brief Returns original points vector, it is changed in place by the
+  /// thread that owns the model, other threads use GetSnapshot
   /// @return points vector
   std::vector<vertice>* GetPoints() { return points; }
 
   /// @brief Returns original polygons vector
   /// @return polygons vector
-  std::vector<std::vector<int>>* GetPoligons() { return polygons; }
+  const FaceList* GetPoligons() { return polygons.get(); }
+
+  /// @brief Returns the last published geometry version, may be called from
+  /// any thread while the model is being changed
+  /// @return A handle that keeps the version alive
+  geometry_snapshot GetSnapshot() {
+    return snapshot.load(std::memory_order_acquire);
+  }
+
+  /// @brief Returns memory statistics of the last load
+  /// @return Allocations made while parsing and if storage was reused
+  load_stats GetLoadStats() { return stats; }
+
+  /// @brief Returns the bounding box of the model before it was centered
+  /// @return Bounding box in the file's coordinates
+  bounding_box GetSourceBounds() { return source_bounds; }
 
   /// @brief Returns current zoom values
   /// @return Current zoom values
@@ -138,6 +331,14 @@ class Model {
   /// @return Current points' shape value
   int GetCurrentShapePoints() { return points_shape; }
 
+  /// @brief Returns current faces' shape value
+  /// @return Current faces' shape value
+  int GetCurrentShapeFaces() { return faces_shape; }
+
+  /// @brief Returns current hidden lines value
+  /// @return Current hidden lines value
+  int GetCurrentHiddenLines() { return hidden_lines; }
+
   /// @brief Returns current lines' width value
   /// @return Current lines' width value
   int GetCurrentLineWidth() { return lines_width; }
@@ -149,6 +350,8 @@ class Model {
   void ChangeLineWidth();
   void ChangeLineShape();
   void ChangePointShape();
+  void ChangeFaceShape();
+  void ChangeHiddenLines();
 
   void SaveSettings();
   void LoadSettings();
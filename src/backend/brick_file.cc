@@ -0,0 +1,405 @@
+/**
+ @file brick_file.cc
+ @brief Contains the implementation of BrickFile class
+ */
+
+#include "brick_file.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+#include "backend.h"
+
+namespace {
+const char MAGIC[8] = {'S', '2', '1', 'B', 'R', 'I', 'C', 'K'};
+
+/// Largest size of the records a brick collects in memory before they are
+/// spilled
+constexpr size_t SPILL_BYTES = 64 << 10;
+/// Smallest size of the records a brick collects before they are spilled,
+/// used for fine grids, where bricks share SPILL_BUDGET
+constexpr size_t MIN_SPILL_BYTES = 1 << 10;
+/// Memory the records of all bricks may take together while converting
+constexpr size_t SPILL_BUDGET = 256 << 20;
+
+/// @brief Records of one brick collected while converting: vertex records
+/// (a zero count and a global index) and face records (a count and global
+/// indices). They are spilled to a temporary file in pieces
+typedef struct {
+  std::vector<uint8_t> buffer;
+  std::vector<std::pair<uint64_t, uint64_t>> pieces;
+} brick_records;
+
+/// @brief Extends a bounding box by a point
+/// @param box A bounding box
+/// @param point A point
+void Extend(s21::bounding_box* box, const s21::vertice& point) {
+  box->min = {std::min(box->min.x, point.x), std::min(box->min.y, point.y),
+              std::min(box->min.z, point.z)};
+  box->max = {std::max(box->max.x, point.x), std::max(box->max.y, point.y),
+              std::max(box->max.z, point.z)};
+}
+
+/// @brief Writes all elements of an array, an empty one writes nothing
+/// @param values An array
+/// @param out A file opened for writing
+/// @return False if the file couldn't take them
+template <typename T>
+bool WriteValues(const std::vector<T>& values, FILE* out) {
+  return values.empty() ||
+         fwrite(values.data(), sizeof(T), values.size(), out) == values.size();
+}
+
+/// @brief Finds a grid cell along one axis
+/// @param value Coordinate
+/// @param min Minimum of the bounding box along the axis
+/// @param max Maximum of the bounding box along the axis
+/// @param grid Cells per axis
+/// @return Cell number
+uint32_t Cell(double value, double min, double max, uint32_t grid) {
+  if (max <= min) return 0;
+  double cell = (value - min) / (max - min) * grid;
+  if (cell < 0) return 0;
+  if (cell >= grid) return grid - 1;
+  return (uint32_t)cell;
+}
+
+/// @brief Finds the brick a point belongs to
+/// @param point A point
+/// @param box Bounding box of the model
+/// @param grid Cells per axis
+/// @return Brick number
+uint32_t BrickOf(const s21::vertice& point, const s21::bounding_box& box,
+                 uint32_t grid) {
+  return (Cell(point.z, box.min.z, box.max.z, grid) * grid +
+          Cell(point.y, box.min.y, box.max.y, grid)) *
+             grid +
+         Cell(point.x, box.min.x, box.max.x, grid);
+}
+
+/// @brief Adds a value to a brick's records, spilling them when the buffer
+/// is full. The buffer is allocated once with room for the largest value
+/// past the limit, so it never grows beyond it
+/// @param records Records of the brick
+/// @param value Value to be added
+/// @param limit Size of the buffer the records are spilled at
+/// @param spill Temporary file
+/// @return False if spilling failed
+template <typename T>
+bool Append(brick_records* records, T value, size_t limit, FILE* spill) {
+  if (records->buffer.capacity() == 0)
+    records->buffer.reserve(limit + sizeof(uint64_t));
+  const uint8_t* bytes = (const uint8_t*)&value;
+  records->buffer.insert(records->buffer.end(), bytes, bytes + sizeof(T));
+  if (records->buffer.size() < limit) return true;
+  if (fseek(spill, 0, SEEK_END) != 0) return false;
+  uint64_t offset = (uint64_t)ftell(spill);
+  if (fwrite(records->buffer.data(), 1, records->buffer.size(), spill) !=
+      records->buffer.size())
+    return false;
+  records->pieces.push_back({offset, records->buffer.size()});
+  records->buffer.clear();
+  return true;
+}
+
+/// @brief Reads all records of a brick back into one buffer
+/// @param records Records of the brick
+/// @param spill Temporary file
+/// @param out Destination buffer
+/// @return False if reading failed
+bool Gather(const brick_records& records, FILE* spill,
+            std::vector<uint8_t>* out) {
+  out->clear();
+  for (const std::pair<uint64_t, uint64_t>& piece : records.pieces) {
+    size_t start = out->size();
+    out->resize(start + piece.second);
+    if (fseek(spill, (long)piece.first, SEEK_SET) != 0 ||
+        fread(out->data() + start, 1, piece.second, spill) != piece.second)
+      return false;
+  }
+  out->insert(out->end(), records.buffer.begin(), records.buffer.end());
+  return true;
+}
+
+/// @brief Writes one brick: finds its own and borrowed vertices, converts
+/// faces to local indices and appends the data to the output file
+/// @param bytes Records of the brick
+/// @param vertices All vertices of the model, memory mapped
+/// @param out Output file, positioned at its end
+/// @param info Directory entry to be filled
+/// @return False if writing failed or the brick has more vertices or indices
+/// than the 32-bit directory and face starts can hold
+bool WriteBrick(const std::vector<uint8_t>& bytes,
+                const s21::vertice* vertices, FILE* out,
+                s21::brick_info* info) {
+  std::unordered_map<uint64_t, uint32_t> local;
+  std::vector<uint64_t> globals;
+  std::vector<uint32_t> starts(1, 0), indices;
+  auto find = [&local, &globals](uint64_t global) {
+    auto inserted = local.emplace(global, (uint32_t)globals.size());
+    if (inserted.second) globals.push_back(global);
+    return inserted.first->second;
+  };
+
+  size_t at = 0;
+  while (at + sizeof(uint32_t) <= bytes.size()) {
+    uint32_t count;
+    memcpy(&count, bytes.data() + at, sizeof(count));
+    at += sizeof(count);
+    uint64_t global;
+    if (count == 0) {
+      memcpy(&global, bytes.data() + at, sizeof(global));
+      at += sizeof(global);
+      find(global);
+      continue;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+      memcpy(&global, bytes.data() + at, sizeof(global));
+      at += sizeof(global);
+      indices.push_back(find(global));
+    }
+    if (indices.size() > UINT32_MAX) return false;
+    starts.push_back((uint32_t)indices.size());
+  }
+  // Local indices of later vertices have wrapped around then
+  if (globals.size() > UINT32_MAX) return false;
+
+  info->vertex_count = (uint32_t)globals.size();
+  info->face_count = (uint32_t)(starts.size() - 1);
+  info->index_count = indices.size();
+  info->bounds = {{0, 0, 0}, {0, 0, 0}};
+  if (!globals.empty())
+    info->bounds = {vertices[globals[0]], vertices[globals[0]]};
+  for (uint64_t global : globals) Extend(&info->bounds, vertices[global]);
+
+  std::vector<float> positions;
+  positions.reserve(globals.size() * 3);
+  for (uint64_t global : globals) {
+    positions.push_back((float)(vertices[global].x - info->bounds.min.x));
+    positions.push_back((float)(vertices[global].y - info->bounds.min.y));
+    positions.push_back((float)(vertices[global].z - info->bounds.min.z));
+  }
+
+  long offset = ftell(out);
+  long padding = (8 - offset % 8) % 8;
+  const uint8_t zeros[8] = {0};
+  info->offset = (uint64_t)(offset + padding);
+  return fwrite(zeros, 1, padding, out) == (size_t)padding &&
+         WriteValues(positions, out) && WriteValues(starts, out) &&
+         WriteValues(indices, out);
+}
+}  // namespace
+
+/// @brief Checks if a file starts like a brick file
+/// @param path A full file path
+/// @return True for brick files
+bool s21::BrickFile::IsBrickFile(const char* path) {
+  char magic[sizeof(MAGIC)] = {0};
+  FILE* f = fopen(path, "rb");
+  if (f == NULL) return false;
+  size_t read = fread(magic, 1, sizeof(magic), f);
+  fclose(f);
+  return read == sizeof(magic) && memcmp(magic, MAGIC, sizeof(magic)) == 0;
+}
+
+/// @brief Converts an .obj file to a brick file without holding the model in
+/// memory: the first pass finds the bounding box and stores vertices in a
+/// temporary binary file, which is memory mapped, the second pass sorts
+/// records into bricks, spilling them to another temporary file
+/// @param obj_path Source .obj file
+/// @param path Destination brick file
+/// @param grid Bricks per axis
+/// @return True if the file was written
+bool s21::BrickFile::Build(const char* obj_path, const char* path, int grid) {
+  uint32_t cells = (uint32_t)std::clamp(grid, 1, MAX_GRID);
+  std::string vertex_path = std::string(path) + ".vertices";
+  std::string spill_path = std::string(path) + ".records";
+  FILE* in = fopen(obj_path, "r");
+  FILE* vertex_file = fopen(vertex_path.c_str(), "w+b");
+  FILE* spill = fopen(spill_path.c_str(), "w+b");
+  FILE* out = fopen(path, "wb");
+  bool result = in != NULL && vertex_file != NULL && spill != NULL &&
+                out != NULL;
+
+  brick_header head;
+  memset(&head, 0, sizeof(head));
+  memcpy(head.magic, MAGIC, sizeof(MAGIC));
+  head.version = VERSION;
+  head.grid = cells;
+  head.brick_count = cells * cells * cells;
+
+  obj_tail chunk;
+  parse_position at = {0, ""};
+  while (result && Model::ReadTail(in, at, &chunk, CHUNK_BYTES) &&
+         chunk.position.offset > at.offset) {
+    for (const vertice& point : chunk.points) {
+      if (head.vertex_count == 0) head.bounds = {point, point};
+      Extend(&head.bounds, point);
+      ++head.vertex_count;
+    }
+    head.face_count += chunk.polygons.size();
+    result = WriteValues(chunk.points, vertex_file);
+    at = chunk.position;
+  }
+
+  const vertice* vertices = nullptr;
+  size_t mapped = head.vertex_count * sizeof(vertice);
+  if (result && mapped > 0) {
+    result = fflush(vertex_file) == 0;
+    void* map = result ? mmap(nullptr, mapped, PROT_READ, MAP_SHARED,
+                              fileno(vertex_file), 0)
+                       : MAP_FAILED;
+    result = map != MAP_FAILED;
+    if (result) vertices = (const vertice*)map;
+  }
+
+  std::vector<brick_records> records(head.brick_count);
+  // Bricks of a fine grid spill sooner, so that all of them together stay
+  // within the budget
+  size_t limit = std::clamp(SPILL_BUDGET / head.brick_count, MIN_SPILL_BYTES,
+                            SPILL_BYTES);
+  uint64_t index = 0;
+  at = {0, ""};
+  while (result && Model::ReadTail(in, at, &chunk, CHUNK_BYTES) &&
+         chunk.position.offset > at.offset) {
+    for (const vertice& point : chunk.points) {
+      brick_records* brick = &records[BrickOf(point, head.bounds, cells)];
+      result = result && Append(brick, (uint32_t)0, limit, spill) &&
+               Append(brick, index++, limit, spill);
+    }
+    for (FaceView loop : chunk.polygons) {
+      uint32_t count = 0;
+      for (int64_t i : loop) count += i >= 0 && (uint64_t)i < head.vertex_count;
+      if (count == 0) {
+        --head.face_count;
+        continue;
+      }
+      brick_records* brick = nullptr;
+      for (int64_t i : loop) {
+        if (i < 0 || (uint64_t)i >= head.vertex_count) continue;
+        if (brick == nullptr) {
+          brick = &records[BrickOf(vertices[i], head.bounds, cells)];
+          result = result && Append(brick, count, limit, spill);
+        }
+        result = result && Append(brick, (uint64_t)i, limit, spill);
+      }
+    }
+    at = chunk.position;
+  }
+
+  std::vector<brick_info> directory(head.brick_count);
+  result = result && fwrite(&head, sizeof(head), 1, out) == 1 &&
+           WriteValues(directory, out);
+  std::vector<uint8_t> bytes;
+  for (size_t brick = 0; result && brick < records.size(); ++brick) {
+    result = Gather(records[brick], spill, &bytes) &&
+             WriteBrick(bytes, vertices, out, &directory[brick]);
+    records[brick] = brick_records();
+  }
+  result = result && fseek(out, sizeof(head), SEEK_SET) == 0 &&
+           WriteValues(directory, out);
+
+  if (vertices != nullptr) munmap((void*)vertices, mapped);
+  if (in != NULL) fclose(in);
+  if (vertex_file != NULL) fclose(vertex_file);
+  if (spill != NULL) fclose(spill);
+  if (out != NULL && fclose(out) != 0) result = false;
+  remove(vertex_path.c_str());
+  remove(spill_path.c_str());
+  if (!result) remove(path);
+  return result;
+}
+
+/// @brief Maps a brick file into memory, nothing is read until bricks are
+/// used
+/// @param path A full file path
+/// @return False if the file can't be mapped or is not a brick file
+bool s21::BrickFile::Open(const char* path) {
+  Close();
+  fd = open(path, O_RDONLY);
+  struct stat info;
+  if (fd < 0 || fstat(fd, &info) != 0 ||
+      (size_t)info.st_size < sizeof(brick_header)) {
+    Close();
+    return false;
+  }
+  void* map = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    Close();
+    return false;
+  }
+  data = (const uint8_t*)map;
+  size = info.st_size;
+  header = (const brick_header*)data;
+  bool valid = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+               header->version == VERSION &&
+               sizeof(brick_header) +
+                       header->brick_count * sizeof(brick_info) <=
+                   size;
+  for (size_t brick = 0; valid && brick < header->brick_count; ++brick) {
+    const brick_info& entry = GetBrick(brick);
+    valid = entry.offset + entry.vertex_count * 3 * sizeof(float) +
+                (entry.face_count + 1 + entry.index_count) *
+                    sizeof(uint32_t) <=
+            size;
+  }
+  if (!valid) Close();
+  return valid;
+}
+
+/// @brief Unmaps the file
+void s21::BrickFile::Close() {
+  if (data != nullptr) munmap((void*)data, size);
+  if (fd >= 0) close(fd);
+  fd = -1;
+  data = nullptr;
+  size = 0;
+  header = nullptr;
+}
+
+/// @brief Appends a brick to model vectors, indices are shifted by the
+/// number of vertices already in the vector
+/// @param brick Brick number
+/// @param vertices Points vector, coordinates are the file's ones
+/// @param faces Polygons vector
+void s21::BrickFile::ReadBrick(size_t brick, std::vector<vertice>* vertices,
+                               FaceList* faces) const {
+  const brick_info& info = GetBrick(brick);
+  const float* positions = (const float*)(data + info.offset);
+  const uint32_t* starts = (const uint32_t*)(positions + info.vertex_count * 3);
+  const uint32_t* indices = starts + info.face_count + 1;
+  int64_t base = (int64_t)vertices->size();
+
+  for (uint32_t i = 0; i < info.vertex_count; ++i) {
+    vertices->push_back({info.bounds.min.x + positions[i * 3],
+                         info.bounds.min.y + positions[i * 3 + 1],
+                         info.bounds.min.z + positions[i * 3 + 2]});
+  }
+  faces->reserve(faces->size() + info.face_count,
+                 faces->CountIndices() + info.index_count);
+  for (uint32_t face = 0; face < info.face_count; ++face) {
+    for (uint32_t i = starts[face]; i < starts[face + 1]; ++i)
+      faces->AddIndex(base + indices[i]);
+    faces->CloseFace();
+  }
+}
+
+/// @brief Lets the system drop the brick's pages from memory, they are read
+/// from disk again when the brick is used next time
+/// @param brick Brick number
+void s21::BrickFile::Release(size_t brick) const {
+  const brick_info& info = GetBrick(brick);
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t begin = info.offset / page * page;
+  size_t end = info.offset + info.vertex_count * 3 * sizeof(float) +
+               (info.face_count + 1 + info.index_count) * sizeof(uint32_t);
+  madvise((void*)(data + begin), end - begin, MADV_DONTNEED);
+}
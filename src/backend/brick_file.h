@@ -0,0 +1,96 @@
+/**
+ @file brick_file.h
+ @brief Contains BrickFile class declaration
+ @details A brick file stores a model split by a regular grid over its
+          bounding box, every brick holds its own vertices and the faces
+          whose first vertex lies in it:
+          header, brick_info for every brick, then the bricks' data, each
+          one 8-byte aligned: float positions relative to the brick's
+          minimum corner (x, y, z per vertex), uint32 face starts
+          (face_count + 1 values) and uint32 indices local to the brick.
+ */
+
+#ifndef BRICK_FILE_H
+#define BRICK_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "controller.h"
+
+namespace s21 {
+/// @brief Beginning of a brick file
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t grid;
+  uint64_t vertex_count;
+  uint64_t face_count;
+  bounding_box bounds;
+  uint32_t brick_count;
+  uint32_t reserved;
+} brick_header;
+
+/// @brief Directory entry of one brick
+typedef struct {
+  uint64_t offset;
+  uint32_t vertex_count;
+  uint32_t face_count;
+  uint64_t index_count;
+  bounding_box bounds;
+} brick_info;
+
+/// @brief Converts .obj files to brick files and maps brick files into
+/// memory, so models larger than RAM are read brick by brick
+class BrickFile {
+ public:
+  static constexpr uint32_t VERSION = 1;
+  static constexpr int DEFAULT_GRID = 8;
+  static constexpr int MAX_GRID = 64;
+  /// Amount of .obj text parsed at once while converting
+  static constexpr long long CHUNK_BYTES = 64 << 20;
+  /// Memory the resident bricks of a model may take by default
+  static constexpr size_t DEFAULT_BUDGET = (size_t)1024 << 20;
+
+  BrickFile() : fd(-1), data(nullptr), size(0), header(nullptr) {}
+  ~BrickFile() { Close(); }
+  BrickFile(const BrickFile&) = delete;
+  BrickFile& operator=(const BrickFile&) = delete;
+
+  static bool IsBrickFile(const char* path);
+  static bool Build(const char* obj_path, const char* path,
+                    int grid = DEFAULT_GRID);
+
+  bool Open(const char* path);
+  void Close();
+
+  /// @brief Returns the header of the opened file
+  /// @return File header
+  const brick_header& GetHeader() const { return *header; }
+
+  /// @brief Returns the number of bricks in the opened file
+  /// @return Number of bricks
+  size_t GetBrickCount() const { return header ? header->brick_count : 0; }
+
+  /// @brief Returns the directory entry of a brick
+  /// @param brick Brick number
+  /// @return Directory entry
+  const brick_info& GetBrick(size_t brick) const {
+    return ((const brick_info*)(header + 1))[brick];
+  }
+
+  void ReadBrick(size_t brick, std::vector<vertice>* vertices,
+                 FaceList* faces) const;
+  void Release(size_t brick) const;
+
+ private:
+  int fd;
+  const uint8_t* data;
+  size_t size;
+  const brick_header* header;
+};
+}  // namespace s21
+
+#endif  // BRICK_FILE_H
@@ -19,6 +19,8 @@ class Constants {
   static constexpr double MIN_SHIFT = -1.0;
   static constexpr int MIN_ZOOM = 1;
   static constexpr int MAX_ZOOM = 100;
+  /// Entries of the post-transform vertex cache meshes are ordered for
+  static constexpr int VERTEX_CACHE_SIZE = 32;
 };
 }  // namespace s21
 
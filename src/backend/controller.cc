@@ -7,7 +7,15 @@
 
 #include "backend.h"
 
-s21::Controller::Controller() : model(std::make_unique<s21::Model>()) {}
+/// @brief Creates a controller with its own model
+/// @param persist_settings If false, the model doesn't read or write the
+/// prefs.txt file, which allows many controllers to work in parallel
+s21::Controller::Controller(bool persist_settings)
+    : model(std::make_unique<s21::Model>(persist_settings)) {}
+
+/// @brief Destroys the controller and its model, defined here because Model
+/// is only a forward declaration in the header
+s21::Controller::~Controller() = default;
 
 /// @brief Gets points vector from the model and returns it
 /// @return points vector
@@ -17,10 +25,17 @@ std::vector<s21::vertice>* s21::Controller::GetPoints() {
 
 /// @brief Gets polygons vector from the model and returns it
 /// @return polygons vector
-std::vector<std::vector<int>>* s21::Controller::GetPolygons() {
+const s21::FaceList* s21::Controller::GetPolygons() {
   return model->GetPoligons();
 }
 
+/// @brief Gets the last published geometry version, safe to call from any
+/// thread
+/// @return Geometry snapshot
+s21::geometry_snapshot s21::Controller::GetSnapshot() {
+  return model->GetSnapshot();
+}
+
 /// @brief Gets current zoom values from the model and returns it
 /// @return Current zoom values
 double s21::Controller::GetZoom() { return model->GetCurrentZoom(); }
@@ -39,6 +54,18 @@ s21::vertice s21::Controller::GetRotation() {
 /// @return Current projection mode value
 int s21::Controller::GetProjectionMode() { return model->GetProjectionMode(); }
 
+/// @brief Gets the bounding box of the opened model in the file's coordinates
+/// @return Bounding box before centering and resizing
+s21::bounding_box s21::Controller::GetBoundingBox() {
+  return model->GetSourceBounds();
+}
+
+/// @brief Gets memory statistics of the last load from the model
+/// @return Allocations made while parsing and if storage was reused
+s21::load_stats s21::Controller::GetLoadStats() {
+  return model->GetLoadStats();
+}
+
 /// @brief Gives to the model a value to be used for rotation around X axis
 /// @param angle A changed angle got from the view
 void s21::Controller::RotateX(int angle) { model->RotateXAngle(angle); }
@@ -75,7 +102,114 @@ void s21::Controller::ResetParams() { model->ResetParams(); }
 
 /// @brief Tells the model to open a given file
 /// @param file File path
-void s21::Controller::OpenFile(const char* file) { model->GetFile(file); }
+/// @return True if the file was opened
+bool s21::Controller::OpenFile(const char* file) {
+  return model->GetFile(file);
+}
+
+/// @brief Sets the largest model OpenFile may load, larger ones are refused
+/// after the pre-scan, before any memory is taken
+/// @param bytes Limit in bytes, 0 means no limit
+void s21::Controller::SetMemoryLimit(size_t bytes) {
+  model->SetMemoryLimit(bytes);
+}
+
+/// @brief Makes OpenFile merge equal or close vertices
+/// @param epsilon Largest distance between merged vertices in the file's
+/// units, 0 merges equal ones only, a negative value turns welding off
+void s21::Controller::SetWelding(double epsilon) {
+  model->SetWelding(epsilon);
+}
+
+/// @brief Makes OpenFile keep positions quantized to 16 bits, see
+/// packed_positions, GetPoints is empty for such models
+/// @param enabled True to turn compact mode on
+void s21::Controller::SetCompact(bool enabled) { model->SetCompact(enabled); }
+
+/// @brief Makes OpenFile reorder faces for the post-transform vertex cache
+/// and renumber vertices in the order faces use them, see ReorderMesh
+/// @param enabled True to turn reordering on
+void s21::Controller::SetReordering(bool enabled) {
+  model->SetReordering(enabled);
+}
+
+/// @brief Gets the number of vertices, packed or not, from the model
+/// @return Number of vertices
+size_t s21::Controller::GetVertexCount() { return model->GetVertexCount(); }
+
+/// @brief Tells the model to choose the bricks of an opened brick file for
+/// the current view, does nothing for .obj files
+/// @return True if the geometry was changed and has to be redrawn
+bool s21::Controller::PageBricks() { return model->PageBricks(); }
+
+/// @brief Sets how much memory the resident bricks of a brick file may take
+/// @param bytes Budget in bytes
+void s21::Controller::SetBrickBudget(size_t bytes) {
+  model->SetBrickBudget(bytes);
+}
+
+/// @brief Makes OpenFile use a cache of recently opened models
+/// @param cache A cache, which may be shared with other controllers, nullptr
+/// disables caching
+void s21::Controller::SetCache(ModelCache* cache) { model->SetCache(cache); }
+
+/// @brief Tells the model to parse a file into the cache without showing it,
+/// the model's own geometry is replaced, so background threads use their own
+/// controllers for this
+/// @param file File path
+/// @return True if the file is in the cache afterwards
+bool s21::Controller::Prefetch(const char* file) {
+  return model->Prefetch(file);
+}
+
+/// @brief Gets the place up to which the opened file was parsed
+/// @return Parse position
+s21::parse_position s21::Controller::GetParsePosition() {
+  return model->GetParsePosition();
+}
+
+/// @brief Reads records appended to a file since it was parsed, doesn't
+/// touch any model, so it may run on a background thread
+/// @param file File path
+/// @param from Position returned by GetParsePosition
+/// @param tail Destination for the appended records
+/// @return False if the file was rewritten or can't be opened
+bool s21::Controller::ReadTail(const char* file, const parse_position& from,
+                               obj_tail* tail) {
+  FILE* f = fopen(file, "r");
+  if (f == NULL) return false;
+  bool result = Model::ReadTail(f, from, tail);
+  fclose(f);
+  return result;
+}
+
+/// @brief Tells the model to add appended records, keeping the current view
+/// @param tail Records read by ReadTail from the current parse position
+/// @param slack How many times the bounding box may outgrow the frame the
+/// model was fitted to before it is refitted, 1 refits on every growth
+/// @return False if the model's parse position is unknown
+bool s21::Controller::AppendTail(const obj_tail& tail, double slack) {
+  return model->AppendTail(tail, slack);
+}
+
+/// @brief Replaces the model with one just loaded by another controller,
+/// keeping the current zoom, rotation and shift
+/// @param loaded A controller that has just opened the new file version
+void s21::Controller::ReloadFrom(Controller* loaded) {
+  model->Reload({loaded->GetSnapshot(), loaded->GetBoundingBox(),
+                 loaded->GetParsePosition()},
+                loaded->model->TakeBricks());
+}
+
+/// @brief Creates a controller for loading files in the background, which
+/// loads them the way this one does: with the same memory limit, welding,
+/// compact mode and brick budget, but without settings persistence
+/// @return The new controller
+std::unique_ptr<s21::Controller> s21::Controller::CreateLoader() {
+  std::unique_ptr<Controller> loader = std::make_unique<Controller>(false);
+  loader->model->CopyLoadSettings(*model);
+  return loader;
+}
 
 /// @brief Gets current lines color value from the model and returns it
 /// @return Current lines color value
@@ -103,6 +237,14 @@ int s21::Controller::GetPointSize() { return model->GetCurrentPointSize(); }
 /// @return Current points shape value
 int s21::Controller::GetShapePoints() { return model->GetCurrentShapePoints(); }
 
+/// @brief Gets current faces shape value from the model and returns it
+/// @return 0 if faces are not filled, 1 for flat shading, 2 for smooth one
+int s21::Controller::GetShapeFaces() { return model->GetCurrentShapeFaces(); }
+
+/// @brief Gets current hidden lines value from the model and returns it
+/// @return 1 if lines behind faces are not drawn, 0 otherwise
+int s21::Controller::GetHiddenLines() { return model->GetCurrentHiddenLines(); }
+
 /// @brief Gets current lines width value from the model and returns it
 /// @return Current lines width value
 int s21::Controller::GetLineWidth() { return model->GetCurrentLineWidth(); }
@@ -118,6 +260,12 @@ void s21::Controller::ChangeLinesColor() { model->ChangeLineColor(); }
 /// @brief Tells the model to change the current lines shape value
 void s21::Controller::ChangeLinesShape() { model->ChangeLineShape(); }
 
+/// @brief Tells the model to change the current faces shape value
+void s21::Controller::ChangeFacesShape() { model->ChangeFaceShape(); }
+
+/// @brief Tells the model to change the current hidden lines value
+void s21::Controller::ChangeHiddenLines() { model->ChangeHiddenLines(); }
+
 /// @brief Tells the model to change the current lines width value
 void s21::Controller::ChangeLinesWidth() { model->ChangeLineWidth(); }
 
@@ -6,9 +6,14 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include <stdint.h>
+
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "face_list.h"
+
 namespace s21 {
 
 /// @brief A struct, which is used to describe points' coordinates and all their
@@ -19,20 +24,161 @@ typedef struct {
   double z;
 } vertice;
 
+/// @brief Axis-aligned bounding box described by its two corners
+typedef struct {
+  vertice min;
+  vertice max;
+} bounding_box;
+
+/// @brief Centered positions quantized to 16 bits per coordinate inside their
+/// bounding box, 6 bytes per vertex instead of 24
+typedef struct {
+  /// x, y, z of every vertex one after another
+  std::vector<uint16_t> values;
+  /// Position of the value 0
+  vertice origin;
+  /// Distance between two neighbouring values
+  vertice step;
+} packed_positions;
+
+/// @brief Indices of many primitives in one stream, drawn with a single call:
+/// primitives are separated by the all-ones value of the width, which
+/// OpenGL's primitive restart starts a new primitive at
+typedef struct {
+  /// Indices, width bytes each
+  SharedArray<uint8_t> indices;
+  /// 2 or 4, 8 only for streams that are not drawn by OpenGL
+  int width;
+  /// Number of indices, restart ones included
+  size_t count;
+} index_stream;
+
+/// @brief Triangles cut from the faces of a model
+typedef struct {
+  /// Vertex indices, three per triangle, with no restart indices
+  index_stream indices;
+  /// Face every triangle was cut from
+  SharedArray<size_t> faces;
+  /// Edges of every triangle that are edges of its face too: bit k is set
+  /// if the edge opposite the triangle's corner k is, so cuts made inside
+  /// a face can be left out of its outline
+  SharedArray<uint8_t> edges;
+} triangle_list;
+
+/// @brief Unit normals of a model in its own space, before zoom, rotation
+/// and shift; zero for faces with no area and vertices of no face
+typedef struct {
+  /// Normal of every face, by face number
+  SharedArray<vertice> faces;
+  /// Normal of every vertex, for smooth shading. Faces added to a model
+  /// change the normals of vertices they share with older faces, chunks
+  /// keep such changes from copying all of them
+  ChunkedArray<vertice> vertices;
+} normal_list;
+
+/// @brief One published version of the model's geometry, it is never changed
+/// after publication, so readers on any thread can use it without locks.
+/// Versions made by appending records share the arrays of the earlier ones
+typedef struct {
+  SharedArray<vertice> points;
+  /// Faces are shared by all versions made from one loaded file
+  std::shared_ptr<const FaceList> polygons;
+  /// Set instead of points for models loaded in compact mode, shared by all
+  /// versions made from one loaded file
+  std::shared_ptr<const packed_positions> packed;
+  /// Maps packed values straight to drawn positions (3x4, row-major)
+  double packed_transform[12];
+  /// Outlines of all faces as line strips, see BuildLineStrips, shared by all
+  /// versions made from one loaded file; null if the faces need 64-bit
+  /// indices
+  std::shared_ptr<const index_stream> line_strips;
+  /// Faces cut into triangles, see Triangulate, shared like line_strips
+  std::shared_ptr<const triangle_list> triangles;
+  /// Normals, see ComputeNormals, shared like line_strips
+  std::shared_ptr<const normal_list> normals;
+  /// Turns normals the way the version's points were turned (3x3, row-major)
+  double normal_rotation[9];
+} geometry;
+
+/// @brief Returns the number of vertices of a geometry version
+/// @param model A geometry version
+/// @return Number of vertices, packed or not
+inline size_t CountPoints(const geometry& model) {
+  return model.packed ? model.packed->values.size() / 3 : model.points.size();
+}
+
+/// @brief Returns a drawn position of a geometry version, packed positions
+/// are unpacked and transformed in one affine step, as a vertex shader would
+/// @param model A geometry version
+/// @param i Vertex number, less than CountPoints
+/// @return The position
+inline vertice GetPoint(const geometry& model, size_t i) {
+  if (!model.packed) return model.points[i];
+  const uint16_t* q = model.packed->values.data() + i * 3;
+  const double* m = model.packed_transform;
+  return {m[0] * q[0] + m[1] * q[1] + m[2] * q[2] + m[3],
+          m[4] * q[0] + m[5] * q[1] + m[6] * q[2] + m[7],
+          m[8] * q[0] + m[9] * q[1] + m[10] * q[2] + m[11]};
+}
+
+/// @brief A reference-counted handle that keeps a geometry version alive
+typedef std::shared_ptr<const geometry> geometry_snapshot;
+
+/// @brief Place in an .obj file up to which it was parsed
+typedef struct {
+  /// Offset after the last complete line, -1 if it is unknown
+  long long offset;
+  /// Bytes right before the offset, they must be unchanged for the rest of
+  /// the file to count as appended
+  std::string check;
+} parse_position;
+
+/// @brief Records appended to an .obj file after a parse_position
+typedef struct {
+  /// Appended vertices in the file's coordinates
+  std::vector<vertice> points;
+  FaceList polygons;
+  /// Where the next read starts
+  parse_position position;
+} obj_tail;
+
+/// @brief Memory statistics of the last model load
+typedef struct {
+  /// Heap allocations made for points and faces while parsing
+  size_t allocations;
+  /// True if the previous model's storage was reused with its capacity
+  bool reused;
+  /// Memory the model takes, estimated by the pre-scan before parsing
+  size_t expected_bytes;
+  /// True if the load was refused because of the memory limit
+  bool refused;
+  /// Vertices removed by welding
+  size_t welded;
+  /// Vertex cache misses per triangle in the file's order, see CountAcmr,
+  /// 0 if reordering is off
+  double acmr_before;
+  /// Vertex cache misses per triangle after reordering
+  double acmr_after;
+} load_stats;
+
 /// @brief Controller class, is needed to connect model and view levels
 class Controller {
  private:
   std::unique_ptr<class Model> model;
 
  public:
-  Controller();
+  explicit Controller(bool persist_settings = true);
+  ~Controller();
 
   std::vector<vertice>* GetPoints();
-  std::vector<std::vector<int>>* GetPolygons();
+  const FaceList* GetPolygons();
+  geometry_snapshot GetSnapshot();
   double GetZoom();
   vertice GetShift();
   vertice GetRotation();
   int GetProjectionMode();
+  bounding_box GetBoundingBox();
+  load_stats GetLoadStats();
 
   void RotateX(int angle);
   void RotateY(int angle);
@@ -48,7 +194,22 @@ class Controller {
 
   void ResetParams();
 
-  void OpenFile(const char* file);
+  bool OpenFile(const char* file);
+  void SetCache(class ModelCache* cache);
+  bool Prefetch(const char* file);
+  void SetMemoryLimit(size_t bytes);
+  void SetWelding(double epsilon);
+  void SetCompact(bool enabled);
+  void SetReordering(bool enabled);
+  size_t GetVertexCount();
+  bool PageBricks();
+  void SetBrickBudget(size_t bytes);
+  parse_position GetParsePosition();
+  static bool ReadTail(const char* file, const parse_position& from,
+                       obj_tail* tail);
+  bool AppendTail(const obj_tail& tail, double slack = 1);
+  void ReloadFrom(Controller* loaded);
+  std::unique_ptr<Controller> CreateLoader();
 
   int GetLinesColor();
   int GetPointsColor();
@@ -56,6 +217,8 @@ class Controller {
   int GetShapeLines();
   int GetPointSize();
   int GetShapePoints();
+  int GetShapeFaces();
+  int GetHiddenLines();
   int GetLineWidth();
 
   void ChangeLinesColor();
@@ -64,6 +227,8 @@ class Controller {
   void ChangeLinesShape();
   void ChangePointsSize();
   void ChangePointsShape();
+  void ChangeFacesShape();
+  void ChangeHiddenLines();
   void ChangeLinesWidth();
 };
 
@@ -0,0 +1,178 @@
+/**
+ @file face_list.cc
+ @brief Contains the implementation of FaceView and FaceList classes
+ */
+
+#include "face_list.h"
+
+/// @brief Compares the indices of two faces
+/// @param other Another face
+/// @return True if both faces have the same indices in the same order
+bool s21::FaceView::operator==(const FaceView& other) const {
+  if (count != other.count) return false;
+  for (size_t i = 0; i < count; ++i)
+    if ((*this)[i] != other[i]) return false;
+  return true;
+}
+
+/// @brief Adds a whole face
+/// @param face Vertex indices of the face
+void s21::FaceList::push_back(const std::vector<int>& face) {
+  for (int index : face) AddIndex(index);
+  CloseFace();
+}
+
+/// @brief Adds all faces of another list, their indices are kept as they are
+/// @param other Faces to be added
+void s21::FaceList::Append(const FaceList& other) {
+  size_t base = CountIndices();
+  size_t count = other.CountIndices();
+  // The arrays grow by doubling rather than to the exact size, so the next
+  // appends write into the storage the copies of this list share
+  if (other.width == width) {
+    // Same width, the stored values are copied as they are
+    if (other.invalid) invalid = true;
+    if (other.max_index > max_index) max_index = other.max_index;
+    if (!indices.Fits(other.indices.size())) ++allocations;
+    indices.append(other.indices.data(), other.indices.size());
+  } else {
+    for (size_t i = 0; i < count; ++i) AddIndex(other.GetIndex(i));
+  }
+  if (!starts.Fits(other.size())) ++allocations;
+  size_t* added = starts.Grow(other.size());
+  for (size_t face = 0; face < other.size(); ++face)
+    added[face] = base + other.starts[face + 1];
+}
+
+/// @brief Replaces vertex indices, used when vertices are merged or reordered
+/// @param map New index for every old one, indices outside it are kept
+void s21::FaceList::Remap(const std::vector<int64_t>& map) {
+  size_t count = CountIndices();
+  std::vector<int64_t> values(count);
+  for (size_t i = 0; i < count; ++i) {
+    int64_t index = GetIndex(i);
+    values[i] = index >= 0 && (uint64_t)index < map.size() ? map[index] : index;
+  }
+  indices.clear();
+  width = 2;
+  max_index = 0;
+  invalid = false;
+  for (int64_t index : values) AddIndex(index);
+}
+
+/// @brief Puts faces into another order, their indices are kept
+/// @param order Old number of every face in the new order, each face once
+void s21::FaceList::Reorder(const std::vector<size_t>& order) {
+  // The copies keep the old arrays, the new ones are written to new blocks
+  SharedArray<size_t> old_starts = starts;
+  SharedArray<uint8_t> old_indices = indices;
+  starts.resize(1);
+  indices.clear();
+  for (size_t face : order) {
+    indices.append(old_indices.data() + old_starts[face] * width,
+                   (old_starts[face + 1] - old_starts[face]) * width);
+    starts.push_back(indices.size() / width);
+  }
+}
+
+/// @brief Removes all faces with one call, the arrays keep their capacity,
+/// so a model of a similar size is loaded without allocations
+void s21::FaceList::clear() {
+  starts.resize(1);
+  indices.clear();
+  width = 2;
+  max_index = 0;
+  invalid = false;
+  allocations = 0;
+}
+
+/// @brief Gives back the capacity the faces don't use
+void s21::FaceList::shrink_to_fit() {
+  starts.shrink_to_fit();
+  indices.shrink_to_fit();
+}
+
+/// @brief Makes room for faces in advance
+/// @param faces Total number of faces
+/// @param total_indices Total number of vertex indices of all faces
+/// @param vertices Number of vertices faces refer to, when it is known the
+/// width is chosen right away instead of widening later
+void s21::FaceList::reserve(size_t faces, size_t total_indices,
+                            size_t vertices) {
+  if (vertices > 0 && WidthFor(vertices - 1) > width) Widen(vertices - 1);
+  if (faces + 1 > starts.capacity()) {
+    starts.reserve(faces + 1);
+    ++allocations;
+  }
+  if (total_indices * width > indices.capacity()) {
+    indices.reserve(total_indices * width);
+    ++allocations;
+  }
+}
+
+/// @brief Counts memory held by the list, including unused capacity
+/// @return Size in bytes
+size_t s21::FaceList::CountBytes() const {
+  return sizeof(FaceList) + starts.capacity() * sizeof(size_t) +
+         indices.capacity();
+}
+
+/// @brief Checks if all indices may be used without checking each one
+/// @param vertices Number of vertices
+/// @return True if every index is valid and less than vertices
+bool s21::FaceList::InRange(size_t vertices) const {
+  return !invalid && (indices.empty() || max_index < vertices);
+}
+
+/// @brief Checks if no valid index reaches a number of vertices, unlike
+/// InRange invalid indices are allowed
+/// @param vertices Number of vertices
+/// @return True if every valid index is less than vertices
+bool s21::FaceList::IndicesBelow(size_t vertices) const {
+  return indices.empty() || max_index < vertices;
+}
+
+/// @brief Compares two lists face by face
+/// @param other Another list
+/// @return True if both lists have the same faces
+bool s21::FaceList::operator==(const FaceList& other) const {
+  if (starts != other.starts) return false;
+  if (width == other.width) return indices == other.indices;
+  for (size_t i = 0; i < CountIndices(); ++i)
+    if (GetIndex(i) != other.GetIndex(i)) return false;
+  return true;
+}
+
+/// @brief Returns the all-ones value of a width, which marks invalid indices,
+/// valid ones must be below it
+/// @param bytes Width
+/// @return The value
+uint64_t s21::FaceList::Limit(int bytes) {
+  if (bytes == 2) return UINT16_MAX;
+  if (bytes == 4) return UINT32_MAX;
+  return INT64_MAX;
+}
+
+/// @brief Finds the narrowest width for an index
+/// @param index Vertex index
+/// @return 2, 4 or 8
+int s21::FaceList::WidthFor(uint64_t index) {
+  if (index < Limit(2)) return 2;
+  if (index < Limit(4)) return 4;
+  return 8;
+}
+
+/// @brief Converts the stored indices to a width that holds an index
+/// @param index The largest index to be stored
+void s21::FaceList::Widen(uint64_t index) {
+  int next = WidthFor(index);
+  if (next <= width) return;
+  size_t count = CountIndices();
+  SharedArray<uint8_t> wider;
+  wider.reserve(indices.capacity() / width * next);
+  uint8_t* values = wider.Grow(count * next);
+  for (size_t i = 0; i < count; ++i) WriteIndex(values, next, i, GetIndex(i));
+  indices = std::move(wider);
+  width = next;
+  ++allocations;
+}
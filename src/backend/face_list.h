@@ -0,0 +1,256 @@
+/**
+ @file face_list.h
+ @brief Contains FaceView and FaceList classes declaration
+ */
+
+#ifndef FACE_LIST_H
+#define FACE_LIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "shared_array.h"
+
+namespace s21 {
+/// @brief Reads one stored index, the all-ones value of every width marks an
+/// invalid index and is read as -1
+/// @param data Stored indices
+/// @param width Bytes per index: 2, 4 or 8
+/// @param i Position of the index
+/// @return Vertex index, -1 if it is invalid
+inline int64_t ReadIndex(const uint8_t* data, int width, size_t i) {
+  if (width == 2) {
+    uint16_t value;
+    memcpy(&value, data + i * 2, 2);
+    return value == UINT16_MAX ? -1 : (int64_t)value;
+  }
+  if (width == 4) {
+    uint32_t value;
+    memcpy(&value, data + i * 4, 4);
+    return value == UINT32_MAX ? -1 : (int64_t)value;
+  }
+  int64_t value;
+  memcpy(&value, data + i * 8, 8);
+  return value;
+}
+
+/// @brief Stores one index, an invalid (negative) one as the all-ones value
+/// @param data Stored indices
+/// @param width Bytes per index: 2, 4 or 8
+/// @param i Position of the index
+/// @param index Vertex index, it must fit the width
+inline void WriteIndex(uint8_t* data, int width, size_t i, int64_t index) {
+  if (width == 2) {
+    uint16_t value = index < 0 ? UINT16_MAX : (uint16_t)index;
+    memcpy(data + i * 2, &value, 2);
+  } else if (width == 4) {
+    uint32_t value = index < 0 ? UINT32_MAX : (uint32_t)index;
+    memcpy(data + i * 4, &value, 4);
+  } else {
+    int64_t value = index < 0 ? -1 : index;
+    memcpy(data + i * 8, &value, 8);
+  }
+}
+
+/// @brief Copies stored indices into a buffer of another width, invalid
+/// ones stay invalid. Indices of the same width are shared, not copied
+/// @param from Stored indices
+/// @param from_width Their bytes per index
+/// @param count Number of indices
+/// @param to Destination, resized to hold count indices
+/// @param width Bytes per index of the copy, not less than from_width
+inline void CopyIndices(const SharedArray<uint8_t>& from, int from_width,
+                        size_t count, SharedArray<uint8_t>* to, int width) {
+  if (from_width == width) {
+    *to = from;
+    to->resize(count * width);
+    return;
+  }
+  to->clear();
+  uint8_t* wider = to->Grow(count * width);
+  for (size_t i = 0; i < count; ++i)
+    WriteIndex(wider, width, i, ReadIndex(from.data(), from_width, i));
+}
+
+/// @brief Read-only vertex indices of one face, valid while the list it was
+/// taken from is unchanged
+class FaceView {
+ public:
+  /// @brief Iterates over the indices of a face
+  class iterator {
+   public:
+    iterator(const FaceView* face, size_t i) : face(face), i(i) {}
+    int64_t operator*() const { return (*face)[i]; }
+    iterator& operator++() {
+      ++i;
+      return *this;
+    }
+    bool operator!=(const iterator& other) const { return i != other.i; }
+    bool operator==(const iterator& other) const { return i == other.i; }
+
+   private:
+    const FaceView* face;
+    size_t i;
+  };
+  typedef iterator const_iterator;
+  typedef int64_t value_type;
+
+  FaceView(const uint8_t* first, size_t count, int width)
+      : first(first), count(count), width(width) {}
+
+  /// @brief Returns the number of vertices of the face
+  /// @return Number of indices
+  size_t size() const { return count; }
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, count); }
+  int64_t operator[](size_t i) const { return ReadIndex(first, width, i); }
+
+  /// @brief Returns an index with bounds checking, like std::vector::at
+  /// @param i Position in the face
+  /// @return Vertex index, -1 if it is invalid
+  int64_t at(size_t i) const {
+    if (i >= count) throw std::out_of_range("FaceView::at");
+    return (*this)[i];
+  }
+
+  /// @brief Returns the stored indices, for drawing them directly
+  /// @return Indices of the face's width
+  const void* data() const { return first; }
+
+  bool operator==(const FaceView& other) const;
+
+ private:
+  const uint8_t* first;
+  size_t count;
+  int width;
+};
+
+/// @brief Faces of a model kept in two flat arrays: vertex indices of all
+/// faces one after another and the place every face starts at. A model
+/// allocates a couple of blocks instead of a vector per face, and clear()
+/// drops all faces at once while keeping the capacity for the next load.
+/// Copies share the arrays, so a copy that gets more faces appended writes
+/// only them. Indices are stored as 16-bit values while they fit, and are
+/// widened to 32 or 64 bits when a larger one is added
+class FaceList {
+ public:
+  /// @brief Iterates over faces, yielding a FaceView for each one
+  class iterator {
+   public:
+    iterator(const FaceList* list, size_t face) : list(list), face(face) {}
+    FaceView operator*() const { return (*list)[face]; }
+    iterator& operator++() {
+      ++face;
+      return *this;
+    }
+    bool operator!=(const iterator& other) const { return face != other.face; }
+    bool operator==(const iterator& other) const { return face == other.face; }
+
+   private:
+    const FaceList* list;
+    size_t face;
+  };
+  typedef iterator const_iterator;
+  typedef FaceView value_type;
+
+  FaceList()
+      : starts(1, 0), width(2), max_index(0), invalid(false), allocations(0) {}
+
+  /// @brief Returns the number of faces
+  /// @return Number of faces
+  size_t size() const { return starts.size() - 1; }
+  bool empty() const { return starts.size() == 1; }
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, size()); }
+
+  FaceView operator[](size_t face) const {
+    return FaceView(indices.data() + starts[face] * width,
+                    starts[face + 1] - starts[face], width);
+  }
+
+  /// @brief Returns a face with bounds checking, like std::vector::at
+  /// @param face Face number
+  /// @return The face's indices
+  FaceView at(size_t face) const {
+    if (face >= size()) throw std::out_of_range("FaceList::at");
+    return (*this)[face];
+  }
+
+  /// @brief Adds a vertex index to the face being built
+  /// @param index Vertex index, a negative one is stored as invalid
+  void AddIndex(int64_t index) {
+    if (index < 0) {
+      invalid = true;
+    } else if ((uint64_t)index > max_index) {
+      max_index = index;
+      if ((uint64_t)index >= Limit(width)) Widen(index);
+    }
+    if (!indices.Fits(width)) ++allocations;
+    WriteIndex(indices.Grow(width), width, 0, index);
+  }
+
+  /// @brief Finishes the face being built, a face may have no indices
+  void CloseFace() {
+    if (!starts.Fits(1)) ++allocations;
+    starts.push_back(CountIndices());
+  }
+
+  void push_back(const std::vector<int>& face);
+  void Append(const FaceList& other);
+  void Remap(const std::vector<int64_t>& map);
+  void Reorder(const std::vector<size_t>& order);
+  void clear();
+  void shrink_to_fit();
+  void reserve(size_t faces, size_t total_indices, size_t vertices = 0);
+  size_t CountBytes() const;
+  bool InRange(size_t vertices) const;
+  bool IndicesBelow(size_t vertices) const;
+  bool operator==(const FaceList& other) const;
+
+  /// @brief Returns the number of vertex indices of all faces
+  /// @return Number of indices
+  size_t CountIndices() const { return indices.size() / width; }
+
+  /// @brief Returns one vertex index by its position among all indices
+  /// @param i Position, less than CountIndices
+  /// @return Vertex index, -1 if it is invalid
+  int64_t GetIndex(size_t i) const {
+    return ReadIndex(indices.data(), width, i);
+  }
+
+  /// @brief Returns how many bytes every stored index takes
+  /// @return 2, 4 or 8
+  int GetIndexWidth() const { return width; }
+
+  /// @brief Returns where faces start: face i uses indices [starts[i];
+  /// starts[i + 1])
+  /// @return Starts array, one element longer than the number of faces
+  const SharedArray<size_t>& GetStarts() const { return starts; }
+
+  /// @brief Returns how many times the arrays had to grow since the last
+  /// clear(), every growth is one heap allocation
+  /// @return Number of allocations
+  size_t GetAllocations() const { return allocations; }
+
+ private:
+  SharedArray<size_t> starts;
+  /// Stored indices, width bytes each
+  SharedArray<uint8_t> indices;
+  int width;
+  /// Largest valid index
+  uint64_t max_index;
+  /// True if an invalid index was added
+  bool invalid;
+  size_t allocations;
+
+  static uint64_t Limit(int bytes);
+  static int WidthFor(uint64_t index);
+  void Widen(uint64_t index);
+};
+}  // namespace s21
+
+#endif  // FACE_LIST_H
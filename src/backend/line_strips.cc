@@ -0,0 +1,69 @@
+/**
+ @file line_strips.cc
+ @brief Contains the implementation of index stream building functions
+ */
+
+#include "line_strips.h"
+
+/// @brief Returns the index that starts a new primitive in a stream
+/// @param width Bytes per index, 2 or 4
+/// @return The all-ones value of the width
+uint64_t s21::RestartIndex(int width) {
+  return width == 2 ? UINT16_MAX : UINT32_MAX;
+}
+
+/// @brief Joins the outlines of all faces into one stream of line strips, so
+/// the whole model is drawn with one call instead of one per face. Every
+/// strip goes around a face and back to its first vertex, indices of
+/// missing vertices are left out. The stream has the faces' index width,
+/// their invalid value is the restart index, which no valid index reaches
+/// @param faces Faces of a model
+/// @param vertices Number of vertices
+/// @param before Stream built for faces [0; first_face), its indices are
+/// shared and only later faces are added, null builds the stream for all
+/// faces
+/// @param first_face Number of faces before covers
+/// @return The stream, null if the faces need 64-bit indices, which OpenGL
+/// can't draw
+std::shared_ptr<const s21::index_stream> s21::BuildLineStrips(
+    const FaceList& faces, size_t vertices, const index_stream* before,
+    size_t first_face) {
+  int width = faces.GetIndexWidth();
+  if (width == 8) return nullptr;
+  std::shared_ptr<index_stream> stream = std::make_shared<index_stream>();
+  stream->width = width;
+  stream->count = 0;
+  if (before == nullptr) {
+    first_face = 0;
+    stream->indices.reserve((faces.CountIndices() + faces.size() * 2) *
+                            width);
+  } else {
+    // Faces may have been widened since, the restart index is widened too
+    CopyIndices(before->indices, before->width, before->count,
+                &stream->indices, width);
+    stream->count = before->count;
+  }
+  auto add = [&stream, width](int64_t index) {
+    WriteIndex(stream->indices.Grow(width), width, 0, index);
+    ++stream->count;
+  };
+
+  for (size_t face = first_face; face < faces.size(); ++face) {
+    FaceView loop = faces[face];
+    int64_t first = -1;
+    size_t used = 0;
+    for (int64_t index : loop) {
+      if (index < 0 || (uint64_t)index >= vertices) continue;
+      if (used == 0) {
+        // The restart index is what an invalid index is stored as
+        if (stream->count > 0) add(-1);
+        first = index;
+      }
+      add(index);
+      ++used;
+    }
+    // Two vertices make one line, more are closed into a loop
+    if (used > 2) add(first);
+  }
+  return stream;
+}
@@ -0,0 +1,23 @@
+/**
+ @file line_strips.h
+ @brief Contains the declaration of index stream building functions
+ */
+
+#ifndef LINE_STRIPS_H
+#define LINE_STRIPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "controller.h"
+
+namespace s21 {
+uint64_t RestartIndex(int width);
+std::shared_ptr<const index_stream> BuildLineStrips(
+    const FaceList& faces, size_t vertices,
+    const index_stream* before = nullptr, size_t first_face = 0);
+}  // namespace s21
+
+#endif  // LINE_STRIPS_H
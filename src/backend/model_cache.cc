@@ -0,0 +1,173 @@
+/**
+ @file model_cache.cc
+ @brief Contains the implementation of ModelCache class
+ */
+
+#include "model_cache.h"
+
+#include <sys/stat.h>
+
+/// @brief Creates an empty cache
+/// @param budget Maximum estimated size of all cached models in bytes
+s21::ModelCache::ModelCache(size_t budget) : stats() { stats.budget = budget; }
+
+/// @brief Reads the modification time, to the nanosecond, and size of a file
+/// @param path A full file path
+/// @param stamp Destination stamp
+/// @return False if the file doesn't exist
+bool s21::ModelCache::Stamp(const char* path, file_stamp* stamp) {
+  struct stat info;
+  if (stat(path, &info) != 0) return false;
+  stamp->mtime = (long long)info.st_mtime;
+#ifdef __APPLE__
+  stamp->mtime_nsec = (long long)info.st_mtimespec.tv_nsec;
+#else
+  stamp->mtime_nsec = (long long)info.st_mtim.tv_nsec;
+#endif
+  stamp->size = (long long)info.st_size;
+  return true;
+}
+
+/// @brief Compares two stamps
+/// @param a A stamp
+/// @param b Another stamp
+/// @return True if both are of the same file version
+bool s21::ModelCache::SameStamp(const file_stamp& a, const file_stamp& b) {
+  return a.mtime == b.mtime && a.mtime_nsec == b.mtime_nsec &&
+         a.size == b.size;
+}
+
+/// @brief Estimates memory used by a model
+/// @param model A model
+/// @return Size in bytes
+size_t s21::ModelCache::CountBytes(const geometry& model) {
+  size_t bytes = sizeof(geometry) + model.points.capacity() * sizeof(vertice);
+  if (model.polygons) bytes += model.polygons->CountBytes();
+  if (model.packed)
+    bytes += sizeof(packed_positions) +
+             model.packed->values.capacity() * sizeof(uint16_t);
+  if (model.line_strips)
+    bytes += sizeof(index_stream) + model.line_strips->indices.capacity();
+  if (model.triangles)
+    bytes += sizeof(triangle_list) +
+             model.triangles->indices.indices.capacity() +
+             model.triangles->faces.capacity() * sizeof(size_t) +
+             model.triangles->edges.capacity();
+  if (model.normals)
+    bytes += sizeof(normal_list) + (model.normals->faces.capacity() +
+                                    model.normals->vertices.capacity()) *
+                                       sizeof(vertice);
+  return bytes;
+}
+
+/// @brief Looks a model up and marks it as the most recently used one, an
+/// entry made from another version of the file is dropped
+/// @param path A full file path
+/// @param stamp Current stamp of the file
+/// @param model Destination, unchanged on a miss
+/// @return True on a hit
+bool s21::ModelCache::Find(const char* path, file_stamp stamp,
+                           cached_model* model) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = index.find(path);
+  if (found != index.end()) {
+    std::list<entry>::iterator it = found->second;
+    if (SameStamp(it->stamp, stamp)) {
+      entries.splice(entries.begin(), entries, it);
+      *model = it->model;
+      ++stats.hits;
+      return true;
+    }
+    Remove(it);
+  }
+  ++stats.misses;
+  return false;
+}
+
+/// @brief Checks if a file version is cached without counting a hit or
+/// touching the order of entries
+/// @param path A full file path
+/// @param stamp Current stamp of the file
+/// @return True if the version is cached
+bool s21::ModelCache::Contains(const char* path, file_stamp stamp) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = index.find(path);
+  return found != index.end() && SameStamp(found->second->stamp, stamp);
+}
+
+/// @brief Checks if a model fits the free part of the budget
+/// @param bytes Estimated size of the model
+/// @return True if no entry would have to be evicted
+bool s21::ModelCache::Fits(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats.bytes + bytes <= stats.budget;
+}
+
+/// @brief Adds a model and evicts the least recently used models that don't
+/// fit the budget
+/// @param path A full file path
+/// @param stamp Stamp of the file the model was read from
+/// @param model A parsed model
+/// @param recent True for a model that is being shown, it becomes the most
+/// recently used one. False for a speculative one, it becomes the least
+/// recently used one and is dropped instead of evicting others
+/// @return True if the model was stored
+bool s21::ModelCache::Insert(const char* path, file_stamp stamp,
+                             const cached_model& model, bool recent) {
+  if (!model.base) return false;
+  size_t bytes = CountBytes(*model.base);
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = index.find(path);
+  if (found != index.end()) Remove(found->second);
+  if (bytes > stats.budget - (recent ? 0 : stats.bytes)) return false;
+  std::list<entry>::iterator it = entries.insert(
+      recent ? entries.begin() : entries.end(), {path, stamp, model, bytes});
+  index[path] = it;
+  stats.bytes += bytes;
+  ++stats.entries;
+  if (!recent) ++stats.prefetched;
+  Evict();
+  return true;
+}
+
+/// @brief Changes the budget, evicting models if needed
+/// @param budget Maximum estimated size of all cached models in bytes
+void s21::ModelCache::SetBudget(size_t budget) {
+  std::lock_guard<std::mutex> lock(mutex);
+  stats.budget = budget;
+  Evict();
+}
+
+/// @brief Removes all models, counters are kept
+void s21::ModelCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  index.clear();
+  stats.entries = 0;
+  stats.bytes = 0;
+}
+
+/// @brief Returns the current counters
+/// @return Cache statistics
+s21::cache_stats s21::ModelCache::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+/// @brief Removes one entry, the mutex must be held
+/// @param it Entry to be removed
+void s21::ModelCache::Remove(std::list<entry>::iterator it) {
+  stats.bytes -= it->bytes;
+  --stats.entries;
+  index.erase(it->path);
+  entries.erase(it);
+}
+
+/// @brief Removes least recently used entries until the budget is met, the
+/// mutex must be held
+void s21::ModelCache::Evict() {
+  while (stats.bytes > stats.budget && !entries.empty()) {
+    Remove(std::prev(entries.end()));
+    ++stats.evictions;
+  }
+}
@@ -0,0 +1,85 @@
+/**
+ @file model_cache.h
+ @brief Contains ModelCache class declaration
+ */
+
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "controller.h"
+
+namespace s21 {
+/// @brief Identifies one version of a file on disk
+typedef struct {
+  long long mtime;
+  /// Nanoseconds of the modification time, a file rewritten within the
+  /// same second with the same size differs only by them
+  long long mtime_nsec;
+  long long size;
+} file_stamp;
+
+/// @brief A parsed and centered model, exactly as it is right after loading
+typedef struct {
+  geometry_snapshot base;
+  bounding_box source_bounds;
+  parse_position position;
+} cached_model;
+
+/// @brief Cache counters, bytes are estimated from the vectors' capacities
+typedef struct {
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+  size_t prefetched;
+  size_t entries;
+  size_t bytes;
+  size_t budget;
+} cache_stats;
+
+/// @brief Least recently used cache of parsed models keyed by path and
+/// modification time, shared by any number of controllers and threads.
+/// Callers loading files in different ways add their load settings to the
+/// path they use
+class ModelCache {
+ public:
+  static constexpr size_t DEFAULT_BUDGET = (size_t)512 << 20;
+
+  explicit ModelCache(size_t budget = DEFAULT_BUDGET);
+
+  static bool Stamp(const char* path, file_stamp* stamp);
+  static size_t CountBytes(const geometry& model);
+
+  bool Find(const char* path, file_stamp stamp, cached_model* model);
+  bool Contains(const char* path, file_stamp stamp);
+  bool Fits(size_t bytes);
+  bool Insert(const char* path, file_stamp stamp, const cached_model& model,
+              bool recent = true);
+  void SetBudget(size_t budget);
+  void Clear();
+  cache_stats GetStats();
+
+ private:
+  typedef struct {
+    std::string path;
+    file_stamp stamp;
+    cached_model model;
+    size_t bytes;
+  } entry;
+
+  std::list<entry> entries;
+  std::unordered_map<std::string, std::list<entry>::iterator> index;
+  std::mutex mutex;
+  cache_stats stats;
+
+  static bool SameStamp(const file_stamp& a, const file_stamp& b);
+  void Remove(std::list<entry>::iterator it);
+  void Evict();
+};
+}  // namespace s21
+
+#endif  // MODEL_CACHE_H
@@ -0,0 +1,218 @@
+/**
+ @file normals.cc
+ @brief Contains the implementation of normal computing functions
+ */
+
+#include "normals.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "parallel.h"
+
+namespace {
+/// Faces and vertices worth giving a thread of their own
+const size_t ITEMS_PER_THREAD = 16384;
+
+/// @brief Turns a drawn direction back into the model's space by the
+/// transpose of the transform, which also scales it by the zoom
+/// @param direction A direction in the drawn space
+/// @param transform Transform the points were drawn with (3x4, row-major),
+/// a rotation times a uniform zoom
+/// @return Direction in the model's space
+s21::vertice Unturn(s21::vertice direction, const double transform[12]) {
+  const double* m = transform;
+  return {m[0] * direction.x + m[4] * direction.y + m[8] * direction.z,
+          m[1] * direction.x + m[5] * direction.y + m[9] * direction.z,
+          m[2] * direction.x + m[6] * direction.y + m[10] * direction.z};
+}
+
+/// @brief Makes a direction unit length, zero stays zero
+/// @param direction Any direction
+/// @return Unit direction
+s21::vertice Normalize(s21::vertice direction) {
+  double length =
+      sqrt(direction.x * direction.x + direction.y * direction.y +
+           direction.z * direction.z);
+  if (length == 0) return {0, 0, 0};
+  return {direction.x / length, direction.y / length, direction.z / length};
+}
+
+/// @brief Turns a drawn direction back into the model's space and makes it
+/// unit length, zero stays zero
+/// @param direction A direction in the drawn space
+/// @param transform Transform the points were drawn with (3x4, row-major),
+/// a rotation times a uniform zoom, so its transpose turns directions back
+/// @return Unit direction in the model's space
+s21::vertice Unrotate(s21::vertice direction, const double transform[12]) {
+  return Normalize(Unturn(direction, transform));
+}
+
+/// @brief Finds a face's normal with Newell's method, missing vertices are
+/// left out
+/// @param model Geometry with the face's drawn vertices
+/// @param loop The face
+/// @param count Number of vertices
+/// @return Normal in the drawn space, as long as twice the face's area
+s21::vertice FaceArea(const s21::geometry& model, s21::FaceView loop,
+                      size_t count) {
+  s21::vertice sum = {0, 0, 0}, first = {0, 0, 0}, previous = {0, 0, 0};
+  bool started = false;
+  for (int64_t index : loop) {
+    if (index < 0 || (uint64_t)index >= count) continue;
+    s21::vertice point = s21::GetPoint(model, index);
+    if (!started) {
+      first = point;
+      started = true;
+    } else {
+      sum.x += (previous.y - point.y) * (previous.z + point.z);
+      sum.y += (previous.z - point.z) * (previous.x + point.x);
+      sum.z += (previous.x - point.x) * (previous.y + point.y);
+    }
+    previous = point;
+  }
+  sum.x += (previous.y - first.y) * (previous.z + first.z);
+  sum.y += (previous.z - first.z) * (previous.x + first.x);
+  sum.z += (previous.x - first.x) * (previous.y + first.y);
+  return sum;
+}
+
+/// @brief Tells if a vertex's normal was given by vn records
+/// @param read Sums of vn records by vertex
+/// @param v Vertex number
+/// @return True if the sum is there and not zero
+bool IsRead(const std::vector<s21::vertice>& read, size_t v) {
+  return v < read.size() &&
+         (read[v].x != 0 || read[v].y != 0 || read[v].z != 0);
+}
+}  // namespace
+
+/// @brief Computes face and vertex normals. A face's normal is found with
+/// Newell's method, which suits concave and slightly non-planar faces, and
+/// is as long as twice the face's area before it is made unit length. A
+/// vertex's normal is the sum of its faces' ones, so it is weighted by
+/// their areas, unless the file gives it with vn records. Faces, then
+/// vertices are split between threads; faces of every vertex are gathered
+/// through an adjacency list, so no two threads write the same normal
+/// @param model Geometry with the faces and their drawn vertices
+/// @param transform Transform the vertices were drawn with (3x4, row-major)
+/// @param read Sums of vn records by vertex, zero or missing ones are
+/// computed
+/// @param threads Number of threads, 0 chooses by the size of the model
+/// @return Normals in the model's own space
+std::shared_ptr<const s21::normal_list> s21::ComputeNormals(
+    const geometry& model, const double transform[12],
+    const std::vector<vertice>& read, int threads) {
+  const FaceList& faces = *model.polygons;
+  size_t count = CountPoints(model);
+  std::shared_ptr<normal_list> result = std::make_shared<normal_list>();
+  std::vector<vertice> areas(faces.size());
+  vertice* face_normals = result->faces.Grow(faces.size());
+  // Every chunk is new, so threads may set vertices of the same one
+  result->vertices.resize(count);
+  if (threads <= 0)
+    threads = CountThreads(faces.size() + count, ITEMS_PER_THREAD);
+
+  ParallelFor(faces.size(), threads, [&](size_t begin, size_t end, int) {
+    for (size_t face = begin; face < end; ++face) {
+      areas[face] = FaceArea(model, faces[face], count);
+      face_normals[face] = Unrotate(areas[face], transform);
+    }
+  });
+
+  // Faces of vertex v are adjacent[first[v]] .. adjacent[first[v + 1] - 1]
+  std::vector<size_t> first(count + 1, 0);
+  for (FaceView loop : faces)
+    for (int64_t index : loop)
+      if (index >= 0 && (uint64_t)index < count) ++first[index + 1];
+  for (size_t v = 0; v < count; ++v) first[v + 1] += first[v];
+  std::vector<size_t> adjacent(first[count]);
+  std::vector<size_t> fill(first.begin(), first.end() - 1);
+  for (size_t face = 0; face < faces.size(); ++face)
+    for (int64_t index : faces[face])
+      if (index >= 0 && (uint64_t)index < count)
+        adjacent[fill[index]++] = face;
+
+  // vn records are in the model's space already, zoom and centering only
+  // moved and scaled the points
+  const double identity[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+  ParallelFor(count, threads, [&](size_t begin, size_t end, int) {
+    for (size_t v = begin; v < end; ++v) {
+      if (IsRead(read, v)) {
+        result->vertices.Set(v, Unrotate(read[v], identity));
+        continue;
+      }
+      vertice sum = {0, 0, 0};
+      for (size_t a = first[v]; a < first[v + 1]; ++a) {
+        sum.x += areas[adjacent[a]].x;
+        sum.y += areas[adjacent[a]].y;
+        sum.z += areas[adjacent[a]].z;
+      }
+      result->vertices.Set(v, Unrotate(sum, transform));
+    }
+  });
+  return result;
+}
+
+/// @brief Adds normals of faces appended after the ones normals were
+/// computed for. Only the new faces' normals are computed and only the
+/// vertices they use get new normals, from area sums kept between calls.
+/// The result shares the arrays of the earlier normals and copies only the
+/// chunks of vertices whose normals change.
+/// The sums are in the model's centered space, which the drawn one only
+/// turns and zooms, so they stay valid when the view changes
+/// @param model Geometry with all faces and their drawn vertices
+/// @param transform Transform the vertices were drawn with (3x4, row-major)
+/// @param read Sums of vn records by vertex, zero or missing ones are
+/// computed
+/// @param before Normals computed for faces [0; first_face)
+/// @param first_face Number of faces before covers
+/// @param sums Area sums by vertex, they are counted for the old faces if
+/// their number doesn't match the vertices of before
+/// @return Normals in the model's own space
+std::shared_ptr<const s21::normal_list> s21::AppendNormals(
+    const geometry& model, const double transform[12],
+    const std::vector<vertice>& read, const normal_list& before,
+    size_t first_face, std::vector<vertice>* sums) {
+  const FaceList& faces = *model.polygons;
+  size_t count = CountPoints(model);
+  std::shared_ptr<normal_list> result = std::make_shared<normal_list>(before);
+  result->faces.resize(first_face, {0, 0, 0});
+  vertice* face_normals = result->faces.Grow(faces.size() - first_face);
+  result->vertices.resize(count, {0, 0, 0});
+
+  // The transform's rows are as long as the zoom, the transpose scales
+  // directions once more, areas are scaled by zoom squared before
+  const double* m = transform;
+  double zoom = sqrt(m[0] * m[0] + m[4] * m[4] + m[8] * m[8]);
+  double cube = zoom * zoom * zoom;
+  if (cube == 0) cube = 1;
+  auto add = [&](size_t face, vertice area) {
+    area = Unturn(area, transform);
+    area = {area.x / cube, area.y / cube, area.z / cube};
+    for (int64_t index : faces[face]) {
+      if (index < 0 || (uint64_t)index >= count) continue;
+      vertice& sum = (*sums)[index];
+      sum = {sum.x + area.x, sum.y + area.y, sum.z + area.z};
+    }
+  };
+  bool counted = sums->size() == before.vertices.size();
+  sums->resize(count, {0, 0, 0});
+  if (!counted) {
+    std::fill(sums->begin(), sums->end(), vertice{0, 0, 0});
+    for (size_t face = 0; face < first_face; ++face)
+      add(face, FaceArea(model, faces[face], count));
+  }
+
+  for (size_t face = first_face; face < faces.size(); ++face) {
+    vertice area = FaceArea(model, faces[face], count);
+    face_normals[face - first_face] = Unrotate(area, transform);
+    add(face, area);
+  }
+  for (size_t face = first_face; face < faces.size(); ++face)
+    for (int64_t index : faces[face])
+      if (index >= 0 && (uint64_t)index < count && !IsRead(read, index))
+        result->vertices.Set(index, Normalize((*sums)[index]));
+  return result;
+}
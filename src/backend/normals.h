@@ -0,0 +1,24 @@
+/**
+ @file normals.h
+ @brief Contains the declaration of normal computing functions
+ */
+
+#ifndef NORMALS_H
+#define NORMALS_H
+
+#include <memory>
+#include <vector>
+
+#include "controller.h"
+
+namespace s21 {
+std::shared_ptr<const normal_list> ComputeNormals(
+    const geometry& model, const double transform[12],
+    const std::vector<vertice>& read, int threads = 0);
+std::shared_ptr<const normal_list> AppendNormals(
+    const geometry& model, const double transform[12],
+    const std::vector<vertice>& read, const normal_list& before,
+    size_t first_face, std::vector<vertice>* sums);
+}  // namespace s21
+
+#endif  // NORMALS_H
@@ -0,0 +1,45 @@
+/**
+ @file parallel.h
+ @brief Contains helpers for splitting work between threads
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+/// @brief Chooses a number of threads for a loop, so that small loops run on
+/// the calling thread only
+/// @param count Number of items
+/// @param per_thread Smallest number of items worth a thread
+/// @return Number of threads, at least 1
+inline int CountThreads(size_t count, size_t per_thread) {
+  size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  return (int)std::max((size_t)1, std::min(cores, count / per_thread));
+}
+
+/// @brief Splits a range into one contiguous part per thread, the calling
+/// thread takes the first part
+/// @param count Size of the range
+/// @param threads Number of threads
+/// @param function Called as function(begin, end, thread), thread numbers
+/// go from 0 to threads - 1, so callers may keep per-thread data
+template <typename Function>
+void ParallelFor(size_t count, int threads, Function function) {
+  std::vector<std::thread> workers;
+  for (int thread = 1; thread < threads; ++thread) {
+    size_t begin = count * thread / threads;
+    size_t end = count * (thread + 1) / threads;
+    if (begin < end) workers.emplace_back(function, begin, end, thread);
+  }
+  function(0, count / threads, 0);
+  for (std::thread& worker : workers) worker.join();
+}
+}  // namespace s21
+
+#endif  // PARALLEL_H
@@ -0,0 +1,287 @@
+/**
+ @file shared_array.h
+ @brief Contains SharedArray and ChunkedArray class templates
+ @details Both keep the data of published geometry versions. A version is
+          copied when it is extended, and the copy must not cost as much as
+          the whole model, so copies share their storage and only the part
+          that is added or changed is written.
+ */
+
+#ifndef SHARED_ARRAY_H
+#define SHARED_ARRAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace s21 {
+/// @brief A contiguous array whose copies share one block of storage. Every
+/// copy sees its own number of elements; one that ends where the block was
+/// last written to is extended in place, past everything other copies see,
+/// so extending a copy costs only the added elements. Elements a copy sees
+/// are never written while another copy shares the block, it is copied
+/// first then. One copy must not be changed by several threads at once,
+/// different copies may. Elements are copied bytewise
+template <typename T>
+class SharedArray {
+ public:
+  typedef T value_type;
+
+  SharedArray() : count(0) {}
+  SharedArray(size_t n, const T& value) : count(0) { resize(n, value); }
+  SharedArray(std::initializer_list<T> values) : count(0) {
+    append(values.begin(), values.size());
+  }
+
+  /// @brief Returns the number of elements this copy sees
+  /// @return Number of elements
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  /// @brief Returns how many elements the block holds before it has to be
+  /// copied into a larger one
+  /// @return Number of elements
+  size_t capacity() const { return storage ? storage->capacity : 0; }
+
+  const T* data() const { return storage ? storage->values.get() : nullptr; }
+  const T* begin() const { return data(); }
+  const T* end() const { return data() + count; }
+  const T& operator[](size_t i) const { return storage->values[i]; }
+  const T& back() const { return storage->values[count - 1]; }
+
+  /// @brief Tells which contents the elements have: two copies with the
+  /// same version agree on the elements both of them see, so a reader that
+  /// has the first n elements of one version needs only the rest
+  /// @return Version of the block, 0 for an empty array
+  uint64_t GetVersion() const { return storage ? storage->version : 0; }
+
+  /// @brief Checks if adding elements writes in place
+  /// @param n Number of elements to be added
+  /// @return False if the block is full or another copy has written past
+  /// this one's end, a larger block is allocated then
+  bool Fits(size_t n) const {
+    return storage && count + n <= storage->capacity &&
+           (storage.use_count() == 1 ||
+            storage->used.load(std::memory_order_relaxed) == count);
+  }
+
+  /// @brief Adds elements whose values are written by the caller
+  /// @param n Number of elements
+  /// @return The first added element
+  T* Grow(size_t n) {
+    size_t next = count + n;
+    if (!Claim(next)) Reallocate(std::max(next, count * 2));
+    T* added = storage->values.get() + count;
+    count = next;
+    storage->used.store(next, std::memory_order_relaxed);
+    return added;
+  }
+
+  void push_back(const T& value) { *Grow(1) = value; }
+
+  /// @brief Adds copies of elements
+  /// @param first First element to be added
+  /// @param n Number of elements
+  void append(const T* first, size_t n) {
+    if (n > 0) std::copy(first, first + n, Grow(n));
+  }
+
+  void resize(size_t n, const T& value = T()) {
+    if (n <= count)
+      count = n;
+    else
+      std::fill_n(Grow(n - count), n - count, value);
+  }
+
+  /// @brief Drops all elements, the block is kept for the next ones if no
+  /// other copy shares it
+  void clear() { count = 0; }
+
+  void reserve(size_t n) {
+    if (n > capacity()) Reallocate(n);
+  }
+
+  void shrink_to_fit() {
+    if (count == 0)
+      storage.reset();
+    else if (count < capacity())
+      Reallocate(count);
+  }
+
+  /// @brief Returns the elements for writing, the block is copied first if
+  /// another copy shares it
+  /// @return The first element
+  T* MutableData() {
+    if (!storage) return nullptr;
+    if (storage.use_count() == 1) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      storage->version = NextVersion();
+    } else {
+      Reallocate(capacity());
+    }
+    return storage->values.get();
+  }
+
+  bool operator==(const SharedArray& other) const {
+    return count == other.count && std::equal(begin(), end(), other.begin());
+  }
+
+ private:
+  struct block {
+    std::unique_ptr<T[]> values;
+    size_t capacity;
+    /// Elements written so far, copies see only ones below it
+    std::atomic<size_t> used;
+    uint64_t version;
+  };
+
+  std::shared_ptr<block> storage;
+  size_t count;
+
+  /// @brief Takes the elements up to a size in the current block
+  /// @param next Size this copy is going to have
+  /// @return False if the block can't hold them for this copy
+  bool Claim(size_t next) {
+    if (!storage || next > storage->capacity) return false;
+    if (storage.use_count() == 1) {
+      // use_count is a relaxed load, the fence orders the writes after the
+      // last reader's release of the block
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // Elements dropped by clear or resize are written again
+      if (storage->used.load(std::memory_order_relaxed) > count)
+        storage->version = NextVersion();
+      return true;
+    }
+    size_t expected = count;
+    return storage->used.compare_exchange_strong(expected, next,
+                                                 std::memory_order_relaxed);
+  }
+
+  /// @brief Moves the elements this copy sees into a new block
+  /// @param size Number of elements the new block holds
+  void Reallocate(size_t size) {
+    std::shared_ptr<block> next = std::make_shared<block>();
+    next->values.reset(new T[std::max(size, (size_t)1)]);
+    next->capacity = std::max(size, (size_t)1);
+    next->used.store(count, std::memory_order_relaxed);
+    next->version = NextVersion();
+    if (count > 0) std::copy(begin(), end(), next->values.get());
+    storage = std::move(next);
+  }
+
+  static uint64_t NextVersion() {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+/// @brief An array kept in fixed-size chunks that its copies share, for data
+/// that is changed here and there rather than extended: a copy takes one
+/// pointer per chunk, and changing an element copies only its chunk if
+/// another copy shares it. The last chunk holds only as many elements as it
+/// needs, so a small array doesn't take a whole chunk
+template <typename T>
+class ChunkedArray {
+ public:
+  /// Elements per chunk
+  static constexpr size_t CHUNK = 4096;
+
+  ChunkedArray() : count(0), tail(0) {}
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  size_t capacity() const {
+    return chunks.empty() ? 0 : (chunks.size() - 1) * CHUNK + tail;
+  }
+  const T& operator[](size_t i) const { return chunks[i / CHUNK][i % CHUNK]; }
+
+  /// @brief Changes one element. Different elements may be set by several
+  /// threads at once only if no other copy shares their chunks
+  /// @param i Element number, less than size()
+  /// @param value New value
+  void Set(size_t i, const T& value) { Own(i / CHUNK)[i % CHUNK] = value; }
+
+  void resize(size_t n, const T& value = T()) {
+    size_t from = count;
+    size_t used = (n + CHUNK - 1) / CHUNK;
+    if (used < chunks.size()) {
+      chunks.resize(used);
+      tail = used == 0 ? 0 : CHUNK;
+    }
+    count = n;
+    while (from < n) {
+      size_t chunk = from / CHUNK;
+      size_t to = std::min(n, (chunk + 1) * CHUNK);
+      T* values = Fit(chunk, to - chunk * CHUNK);
+      std::fill(values + from % CHUNK, values + (to - chunk * CHUNK), value);
+      from = to;
+    }
+  }
+
+  bool operator==(const ChunkedArray& other) const {
+    if (count != other.count) return false;
+    for (size_t i = 0; i < count; ++i)
+      if (!((*this)[i] == other[i])) return false;
+    return true;
+  }
+
+ private:
+  std::vector<std::shared_ptr<T[]>> chunks;
+  size_t count;
+  /// Number of elements the last chunk holds
+  size_t tail;
+
+  /// @brief Returns how many elements a chunk holds
+  /// @param chunk Chunk number
+  /// @return Number of elements
+  size_t Length(size_t chunk) const {
+    return chunk + 1 == chunks.size() ? tail : CHUNK;
+  }
+
+  /// @brief Makes a chunk this copy's own and large enough, allocating or
+  /// copying it. The last chunk grows by doubling up to a whole chunk
+  /// @param chunk Chunk number, at most the number of chunks
+  /// @param length Number of elements it has to hold
+  /// @return Its elements
+  T* Fit(size_t chunk, size_t length) {
+    if (chunk == chunks.size()) {
+      chunks.emplace_back();
+      tail = 0;
+    }
+    size_t held = Length(chunk);
+    if (held >= length) return Own(chunk);
+    // Only the last chunk can be too small
+    size_t size = std::min(CHUNK, std::max(length, held * 2));
+    std::shared_ptr<T[]> values(new T[size]());
+    if (held > 0)
+      std::copy(chunks[chunk].get(), chunks[chunk].get() + held, values.get());
+    chunks[chunk] = std::move(values);
+    tail = size;
+    return chunks[chunk].get();
+  }
+
+  /// @brief Makes a chunk this copy's own, copying it if another copy
+  /// shares it
+  /// @param chunk Chunk number
+  /// @return Its elements
+  T* Own(size_t chunk) {
+    std::shared_ptr<T[]>& values = chunks[chunk];
+    if (values.use_count() != 1) {
+      size_t length = Length(chunk);
+      std::shared_ptr<T[]> copy(new T[length]);
+      std::copy(values.get(), values.get() + length, copy.get());
+      values = std::move(copy);
+    } else {
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return values.get();
+  }
+};
+}  // namespace s21
+
+#endif  // SHARED_ARRAY_H
@@ -0,0 +1,38 @@
+/**
+ @file tail_reader.cc
+ @brief Contains the implementation of TailReader class
+ */
+
+#include "tail_reader.h"
+
+#include "backend.h"
+
+/// @brief Opens a file to be followed, closing the previous one
+/// @param path A full file path
+/// @return True if the file was opened
+bool s21::TailReader::Open(const char* path) {
+  Close();
+  file = fopen(path, "r");
+  return file != NULL;
+}
+
+/// @brief Closes the followed file
+void s21::TailReader::Close() {
+  if (file != NULL) fclose(file);
+  file = NULL;
+}
+
+/// @brief Reads the next chunk of appended records, an unfinished last line
+/// is left for the next read
+/// @param from The place the file was parsed up to
+/// @param tail Destination for the records and the new position
+/// @param max_bytes Reading stops at the first line end after this many
+/// bytes, 0 reads everything
+/// @return False if the file is not open or was rewritten
+bool s21::TailReader::Read(const parse_position& from, obj_tail* tail,
+                           long long max_bytes) {
+  if (file == NULL) return false;
+  // The end of a growing file is cached by stdio once it was reached
+  clearerr(file);
+  return Model::ReadTail(file, from, tail, max_bytes);
+}
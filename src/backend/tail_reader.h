@@ -0,0 +1,41 @@
+/**
+ @file tail_reader.h
+ @brief Contains TailReader class declaration
+ */
+
+#ifndef TAIL_READER_H
+#define TAIL_READER_H
+
+#include <stdio.h>
+
+#include "controller.h"
+
+namespace s21 {
+/// @brief Keeps an .obj file open and reads records appended to it, like
+/// tail -f. One reader is used by one thread at a time
+class TailReader {
+ public:
+  /// Default amount of text parsed per read, keeps every step short
+  static constexpr long long CHUNK_BYTES = 1 << 20;
+
+  TailReader() : file(NULL) {}
+  ~TailReader() { Close(); }
+  TailReader(const TailReader&) = delete;
+  TailReader& operator=(const TailReader&) = delete;
+
+  bool Open(const char* path);
+  void Close();
+
+  /// @brief Tells if a file is open
+  /// @return True if Open succeeded and Close wasn't called
+  bool IsOpen() const { return file != NULL; }
+
+  bool Read(const parse_position& from, obj_tail* tail,
+            long long max_bytes = CHUNK_BYTES);
+
+ private:
+  FILE* file;
+};
+}  // namespace s21
+
+#endif  // TAIL_READER_H
@@ -0,0 +1,245 @@
+/**
+ @file triangulation.cc
+ @brief Contains the implementation of face triangulation functions
+ */
+
+#include "triangulation.h"
+
+#include <math.h>
+
+#include "parallel.h"
+
+namespace {
+/// Faces worth giving a thread of their own
+const size_t FACES_PER_THREAD = 4096;
+
+/// @brief A corner of a face projected to the face's plane
+typedef struct {
+  double u;
+  double v;
+} corner;
+
+/// @brief Doubled signed area of a triangle, positive if it turns left
+double Cross(const corner& a, const corner& b, const corner& c) {
+  return (b.u - a.u) * (c.v - a.v) - (b.v - a.v) * (c.u - a.u);
+}
+
+/// @brief Finds which edges of a triangle cut from a face are the face's
+/// edges: the ones joining neighbouring corners of the face
+/// @param n Number of the face's corners
+/// @param a,b,c Positions of the triangle's corners in the face
+/// @return Bit k is set if the edge opposite corner k is the face's one
+uint8_t Outline(size_t n, size_t a, size_t b, size_t c) {
+  auto joined = [n](size_t p, size_t q) {
+    return (p + 1) % n == q || (q + 1) % n == p;
+  };
+  return (joined(b, c) ? 1 : 0) | (joined(c, a) ? 2 : 0) |
+         (joined(a, b) ? 4 : 0);
+}
+
+/// @brief Cuts faces into triangles by ear clipping, keeping its buffers
+/// between faces, so a thread allocates only for its largest face
+class EarClipper {
+ public:
+  void Clip(const s21::geometry& model, const std::vector<int64_t>& loop,
+            std::vector<int64_t>* triangles, std::vector<uint8_t>* edges);
+
+ private:
+  std::vector<s21::vertice> points;
+  std::vector<corner> corners;
+  std::vector<size_t> prev;
+  std::vector<size_t> next;
+
+  bool Project(const s21::geometry& model, const std::vector<int64_t>& loop);
+  bool IsEar(size_t i) const;
+  void Cut(const std::vector<int64_t>& loop, size_t a, size_t b, size_t c,
+           std::vector<int64_t>* triangles, std::vector<uint8_t>* edges);
+};
+
+/// @brief Projects a face to the plane its Newell normal is the most
+/// aligned with, turned so the face goes counterclockwise there
+/// @param model Geometry the face's vertices are taken from
+/// @param loop Vertex indices of the face, all of them valid
+/// @return False if the face is degenerate: it has no area
+bool EarClipper::Project(const s21::geometry& model,
+                         const std::vector<int64_t>& loop) {
+  size_t n = loop.size();
+  points.resize(n);
+  s21::vertice normal = {0, 0, 0};
+  for (size_t i = 0; i < n; ++i) points[i] = s21::GetPoint(model, loop[i]);
+  for (size_t i = 0; i < n; ++i) {
+    const s21::vertice& a = points[i];
+    const s21::vertice& b = points[(i + 1) % n];
+    normal.x += (a.y - b.y) * (a.z + b.z);
+    normal.y += (a.z - b.z) * (a.x + b.x);
+    normal.z += (a.x - b.x) * (a.y + b.y);
+  }
+  double ax = fabs(normal.x), ay = fabs(normal.y), az = fabs(normal.z);
+  if (ax == 0 && ay == 0 && az == 0) return false;
+
+  corners.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    const s21::vertice& p = points[i];
+    // The projections keep the axes cyclic, so a face going counterclockwise
+    // around a positive normal component goes counterclockwise in them
+    if (az >= ax && az >= ay)
+      corners[i] = {p.x, normal.z > 0 ? p.y : -p.y};
+    else if (ax >= ay)
+      corners[i] = {p.y, normal.x > 0 ? p.z : -p.z};
+    else
+      corners[i] = {p.z, normal.y > 0 ? p.x : -p.x};
+  }
+  return true;
+}
+
+/// @brief Checks if a corner may be cut off: it is convex and no reflex
+/// corner of the rest of the face lies in the triangle it makes
+/// @param i The corner
+/// @return True if it is an ear
+bool EarClipper::IsEar(size_t i) const {
+  const corner& a = corners[prev[i]];
+  const corner& b = corners[i];
+  const corner& c = corners[next[i]];
+  if (Cross(a, b, c) <= 0) return false;
+  for (size_t j = next[next[i]]; j != prev[i]; j = next[j]) {
+    const corner& p = corners[j];
+    // Convex corners can't be inside an ear without a reflex one inside too
+    if (Cross(corners[prev[j]], p, corners[next[j]]) > 0) continue;
+    // Corners repeating a vertex of the ear touch it and don't block it
+    if ((p.u == a.u && p.v == a.v) || (p.u == b.u && p.v == b.v) ||
+        (p.u == c.u && p.v == c.v))
+      continue;
+    if (Cross(a, b, p) >= 0 && Cross(b, c, p) >= 0 && Cross(c, a, p) >= 0)
+      return false;
+  }
+  return true;
+}
+
+/// @brief Adds a triangle made of three corners of a face
+/// @param loop Vertex indices of the face
+/// @param a,b,c Positions of the triangle's corners in the face
+/// @param triangles Destination, three indices per triangle
+/// @param edges Destination, the face's edges of every triangle
+void EarClipper::Cut(const std::vector<int64_t>& loop, size_t a, size_t b,
+                     size_t c, std::vector<int64_t>* triangles,
+                     std::vector<uint8_t>* edges) {
+  triangles->insert(triangles->end(), {loop[a], loop[b], loop[c]});
+  edges->push_back(Outline(loop.size(), a, b, c));
+}
+
+/// @brief Cuts a face of n vertices into n - 2 triangles, which keep the
+/// face's winding. Concave faces are handled by ear clipping; when no ear
+/// is found, as happens for self-intersecting or degenerate faces, the
+/// current corner is cut anyway, so there are always n - 2 triangles
+/// @param model Geometry the face's vertices are taken from
+/// @param loop Vertex indices of the face, all of them valid, at least 3
+/// @param triangles Destination, three indices per triangle
+/// @param edges Destination, the face's edges of every triangle, see
+/// triangle_list
+void EarClipper::Clip(const s21::geometry& model,
+                      const std::vector<int64_t>& loop,
+                      std::vector<int64_t>* triangles,
+                      std::vector<uint8_t>* edges) {
+  size_t n = loop.size();
+  triangles->clear();
+  edges->clear();
+  if (n == 3 || !Project(model, loop)) {
+    // A fan is as good as any other cut for a triangle or a face with no area
+    for (size_t i = 1; i + 1 < n; ++i) Cut(loop, 0, i, i + 1, triangles, edges);
+    return;
+  }
+
+  prev.resize(n);
+  next.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    prev[i] = (i + n - 1) % n;
+    next[i] = (i + 1) % n;
+  }
+  size_t left = n;
+  size_t i = 0;
+  size_t failed = 0;
+  while (left > 3) {
+    if (failed < left && !IsEar(i)) {
+      i = next[i];
+      ++failed;
+      continue;
+    }
+    Cut(loop, prev[i], i, next[i], triangles, edges);
+    next[prev[i]] = next[i];
+    prev[next[i]] = prev[i];
+    i = prev[i];
+    --left;
+    failed = 0;
+  }
+  Cut(loop, prev[i], i, next[i], triangles, edges);
+}
+}  // namespace
+
+/// @brief Cuts all faces of a model into triangles. Faces are split between
+/// threads, every face's triangles have a place known in advance, so
+/// threads write straight into the result and the order doesn't depend on
+/// their timing. Indices of missing vertices are left out of faces, faces
+/// with less than 3 vertices left give no triangles
+/// @param model Geometry with the faces and their vertices
+/// @param threads Number of threads, 0 chooses by the number of faces
+/// @param before Triangles cut from faces [0; first_face), they are shared
+/// and only later faces are cut, null cuts all faces
+/// @param first_face Number of faces before covers
+/// @return Triangles with the faces' index width
+std::shared_ptr<const s21::triangle_list> s21::Triangulate(
+    const geometry& model, int threads, const triangle_list* before,
+    size_t first_face) {
+  const FaceList& faces = *model.polygons;
+  size_t vertices = CountPoints(model);
+  std::shared_ptr<triangle_list> result = std::make_shared<triangle_list>();
+  if (before == nullptr) first_face = 0;
+  size_t added = faces.size() - first_face;
+
+  // Triangles of face first_face + k start at first[k]
+  std::vector<size_t> first(added + 1, 0);
+  if (before != nullptr) first[0] = before->faces.size();
+  for (size_t k = 0; k < added; ++k) {
+    size_t used = 0;
+    for (int64_t index : faces[first_face + k])
+      if (index >= 0 && (uint64_t)index < vertices) ++used;
+    first[k + 1] = first[k] + (used >= 3 ? used - 2 : 0);
+  }
+  int width = faces.GetIndexWidth();
+  result->indices.width = width;
+  result->indices.count = first.back() * 3;
+  if (before != nullptr) {
+    CopyIndices(before->indices.indices, before->indices.width,
+                before->indices.count, &result->indices.indices, width);
+    result->faces = before->faces;
+    result->edges = before->edges;
+  }
+  // Threads write the added triangles, numbered from first[0]
+  uint8_t* indices =
+      result->indices.indices.Grow((first.back() - first[0]) * 3 * width);
+  size_t* triangle_faces = result->faces.Grow(first.back() - first[0]);
+  uint8_t* triangle_edges = result->edges.Grow(first.back() - first[0]);
+
+  if (threads <= 0) threads = CountThreads(added, FACES_PER_THREAD);
+  ParallelFor(added, threads, [&](size_t begin, size_t end, int) {
+    EarClipper clipper;
+    std::vector<int64_t> loop;
+    std::vector<int64_t> triangles;
+    std::vector<uint8_t> edges;
+    for (size_t k = begin; k < end; ++k) {
+      if (first[k + 1] == first[k]) continue;
+      size_t face = first_face + k;
+      loop.clear();
+      for (int64_t index : faces[face])
+        if (index >= 0 && (uint64_t)index < vertices) loop.push_back(index);
+      clipper.Clip(model, loop, &triangles, &edges);
+      size_t at = first[k] - first[0];
+      for (size_t i = 0; i < triangles.size(); ++i)
+        WriteIndex(indices, width, at * 3 + i, triangles[i]);
+      for (size_t i = 0; i < edges.size(); ++i) {
+        triangle_faces[at + i] = face;
+        triangle_edges[at + i] = edges[i];
+      }
+    }
+  });
+  return result;
+}
@@ -0,0 +1,19 @@
+/**
+ @file triangulation.h
+ @brief Contains the declaration of face triangulation functions
+ */
+
+#ifndef TRIANGULATION_H
+#define TRIANGULATION_H
+
+#include <memory>
+
+#include "controller.h"
+
+namespace s21 {
+std::shared_ptr<const triangle_list> Triangulate(
+    const geometry& model, int threads = 0,
+    const triangle_list* before = nullptr, size_t first_face = 0);
+}  // namespace s21
+
+#endif  // TRIANGULATION_H
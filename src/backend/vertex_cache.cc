@@ -0,0 +1,150 @@
+/**
+ @file vertex_cache.cc
+ @brief Contains the implementation of vertex cache ordering functions
+ */
+
+#include "vertex_cache.h"
+
+#include <stdint.h>
+
+namespace {
+/// @brief Finds the next vertex that still has faces to be emitted
+/// @param live Number of faces left for every vertex
+/// @param cursor Where the search goes on from, moved past the found vertex
+/// @return The vertex, -1 if all faces are emitted
+int64_t NextLive(const std::vector<size_t>& live, size_t* cursor) {
+  while (*cursor < live.size()) {
+    size_t vertex = (*cursor)++;
+    if (live[vertex] > 0) return (int64_t)vertex;
+  }
+  return -1;
+}
+}  // namespace
+
+/// @brief Counts the average cache miss ratio: vertices a FIFO post-transform
+/// cache of the given size has to transform per triangle, a face of n
+/// vertices being n - 2 triangles. It is 3 for a cache that never hits and
+/// approaches 0.5 for a well ordered closed triangle mesh
+/// @param faces Faces in drawing order
+/// @param vertices Number of vertices, indices outside are not counted
+/// @param cache_size Number of cache entries
+/// @return Misses per triangle, 0 for a model with no faces
+double s21::CountAcmr(const FaceList& faces, size_t vertices, int cache_size) {
+  // A vertex is in a FIFO cache while less than cache_size misses happened
+  // after it was loaded
+  std::vector<size_t> loaded(vertices, SIZE_MAX);
+  size_t misses = 0;
+  size_t triangles = 0;
+  for (FaceView loop : faces) {
+    triangles += loop.size() > 3 ? loop.size() - 2 : 1;
+    for (int64_t index : loop) {
+      if (index < 0 || (size_t)index >= vertices) continue;
+      if (loaded[index] != SIZE_MAX &&
+          misses - loaded[index] < (size_t)cache_size)
+        continue;
+      loaded[index] = misses++;
+    }
+  }
+  return triangles == 0 ? 0 : (double)misses / triangles;
+}
+
+/// @brief Reorders faces for the post-transform vertex cache with the
+/// Tipsify algorithm (Sander, Nehab, Barczak 2007), which runs in linear
+/// time: faces are emitted in fans around a vertex, and the next fan is
+/// centered at a vertex of the last faces that is still in the cache.
+/// Vertices are then renumbered in the order faces first use them, so
+/// reading them goes forward through memory. Unused vertices are moved to
+/// the end. Models with invalid indices are left as they are
+/// @param points Vertices, put into the new order
+/// @param faces Faces, put into the new order and renumbered
+/// @param normals Normals by vertex, empty or as long as points, put into
+/// the vertices' order
+/// @param cache_size Number of cache entries the order is made for
+void s21::ReorderMesh(std::vector<vertice>* points, FaceList* faces,
+                      std::vector<vertice>* normals, int cache_size) {
+  size_t count = points->size();
+  size_t face_count = faces->size();
+  if (face_count == 0 || !faces->InRange(count)) return;
+
+  // Faces of vertex v are adjacent[first[v]] .. adjacent[first[v + 1] - 1]
+  std::vector<size_t> first(count + 1, 0);
+  for (FaceView loop : *faces)
+    for (int64_t index : loop) ++first[index + 1];
+  for (size_t v = 0; v < count; ++v) first[v + 1] += first[v];
+  std::vector<size_t> adjacent(first[count]);
+  std::vector<size_t> live(count);
+  std::vector<size_t> fill(first.begin(), first.end() - 1);
+  for (size_t face = 0; face < face_count; ++face)
+    for (int64_t index : (*faces)[face]) adjacent[fill[index]++] = face;
+  for (size_t v = 0; v < count; ++v) live[v] = first[v + 1] - first[v];
+
+  // A vertex is in the cache while time - stamp[v] <= cache_size
+  size_t size = (size_t)cache_size;
+  std::vector<size_t> stamp(count, 0);
+  size_t time = size + 1;
+  std::vector<bool> emitted(face_count, false);
+  std::vector<size_t> order;
+  order.reserve(face_count);
+  std::vector<int64_t> dead_end;
+  std::vector<int64_t> candidates;
+  size_t cursor = 0;
+
+  int64_t fanning = NextLive(live, &cursor);
+  while (fanning >= 0) {
+    candidates.clear();
+    for (size_t a = first[fanning]; a < first[fanning + 1]; ++a) {
+      size_t face = adjacent[a];
+      if (emitted[face]) continue;
+      emitted[face] = true;
+      order.push_back(face);
+      for (int64_t index : (*faces)[face]) {
+        dead_end.push_back(index);
+        candidates.push_back(index);
+        --live[index];
+        if (time - stamp[index] > size) stamp[index] = time++;
+      }
+    }
+
+    // The next fan: a candidate that stays in the cache while its own faces
+    // are emitted, the one loaded earliest first
+    fanning = -1;
+    size_t best = 0;
+    for (int64_t index : candidates) {
+      if (live[index] == 0) continue;
+      size_t priority = 0;
+      if (time - stamp[index] + 2 * live[index] <= size)
+        priority = time - stamp[index];
+      if (fanning < 0 || priority > best) {
+        fanning = index;
+        best = priority;
+      }
+    }
+    while (fanning < 0 && !dead_end.empty()) {
+      int64_t index = dead_end.back();
+      dead_end.pop_back();
+      if (live[index] > 0) fanning = index;
+    }
+    if (fanning < 0) fanning = NextLive(live, &cursor);
+  }
+  // Faces with no vertices are kept, at the end
+  for (size_t face = 0; face < face_count; ++face)
+    if (!emitted[face]) order.push_back(face);
+  faces->Reorder(order);
+
+  std::vector<int64_t> map(count, -1);
+  int64_t next = 0;
+  for (FaceView loop : *faces)
+    for (int64_t index : loop)
+      if (map[index] < 0) map[index] = next++;
+  for (size_t v = 0; v < count; ++v)
+    if (map[v] < 0) map[v] = next++;
+  std::vector<vertice> reordered(count);
+  for (size_t v = 0; v < count; ++v) reordered[map[v]] = (*points)[v];
+  // Copied back, so the points keep their storage for the next load
+  *points = reordered;
+  if (normals != nullptr && normals->size() == count) {
+    for (size_t v = 0; v < count; ++v) reordered[map[v]] = (*normals)[v];
+    *normals = reordered;
+  }
+  faces->Remap(map);
+}
@@ -0,0 +1,24 @@
+/**
+ @file vertex_cache.h
+ @brief Contains the declaration of vertex cache ordering functions
+ */
+
+#ifndef VERTEX_CACHE_H
+#define VERTEX_CACHE_H
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "constants.h"
+#include "controller.h"
+
+namespace s21 {
+double CountAcmr(const FaceList& faces, size_t vertices,
+                 int cache_size = Constants::VERTEX_CACHE_SIZE);
+void ReorderMesh(std::vector<vertice>* points, FaceList* faces,
+                 std::vector<vertice>* normals = nullptr,
+                 int cache_size = Constants::VERTEX_CACHE_SIZE);
+}  // namespace s21
+
+#endif  // VERTEX_CACHE_H
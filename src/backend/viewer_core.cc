@@ -0,0 +1,181 @@
+/**
+ @file viewer_core.cc
+ @brief Contains the implementation of the viewer_core library API
+ */
+
+#include "viewer_core.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "backend.h"
+#include "constants.h"
+
+namespace {
+/// @brief Copies a loaded model into contiguous buffers
+/// @param model A model with a loaded file
+/// @param mesh Destination buffers
+void CopyModel(s21::Model& model, s21::mesh_buffers* mesh) {
+  std::vector<s21::vertice>* points = model.GetPoints();
+  const s21::FaceList* polygons = model.GetPoligons();
+
+  mesh->positions.clear();
+  mesh->positions.reserve(points->size() * 3);
+  for (const s21::vertice& point : *points) {
+    mesh->positions.push_back(point.x);
+    mesh->positions.push_back(point.y);
+    mesh->positions.push_back(point.z);
+  }
+
+  mesh->indices.resize(polygons->CountIndices());
+  for (size_t i = 0; i < mesh->indices.size(); ++i)
+    mesh->indices[i] = polygons->GetIndex(i);
+  mesh->face_offsets.assign(polygons->GetStarts().begin(),
+                            polygons->GetStarts().end());
+  mesh->source_bounds = model.GetSourceBounds();
+}
+
+/// @brief Multiplies two row-major 4x4 matrices
+/// @param a Left matrix
+/// @param b Right matrix
+/// @param out Result, may not alias the arguments
+void Multiply(const double a[16], const double b[16], double out[16]) {
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < 4; ++col) {
+      out[row * 4 + col] = 0;
+      for (int k = 0; k < 4; ++k)
+        out[row * 4 + col] += a[row * 4 + k] * b[k * 4 + col];
+    }
+  }
+}
+
+/// @brief Applies a transform after the current one
+/// @param matrix Current transform, updated in place
+/// @param next Transform to be applied after it
+void Then(double matrix[16], const double next[16]) {
+  double result[16];
+  Multiply(next, matrix, result);
+  for (int i = 0; i < 16; ++i) matrix[i] = result[i];
+}
+}  // namespace
+
+/// @brief Loads and centers an .obj file like the viewer does
+/// @param path A full file path
+/// @param mesh Destination buffers, unchanged if the file can't be opened
+/// @return True if the file was opened
+bool s21::LoadObj(const char* path, mesh_buffers* mesh) {
+  Model model(false);
+  if (!model.GetFile(path)) return false;
+  CopyModel(model, mesh);
+  return true;
+}
+
+/// @brief Loads and centers .obj data that is already in memory
+/// @param data .obj file contents
+/// @param size Size of data in bytes
+/// @param mesh Destination buffers, unchanged if the data can't be read
+/// @param memory_limit Largest estimated size of the loaded model in bytes,
+/// 0 for no limit
+/// @return False if the data can't be read or the model exceeds the limit
+bool s21::LoadObjFromMemory(const char* data, size_t size, mesh_buffers* mesh,
+                            size_t memory_limit) {
+  Model model(false);
+  model.SetMemoryLimit(memory_limit);
+  if (size > 0) {
+    FILE* f = fmemopen((void*)data, size, "r");
+    if (f == NULL) return false;
+    bool result = model.ReadStream(f);
+    fclose(f);
+    if (!result) return false;
+  }
+  CopyModel(model, mesh);
+  return true;
+}
+
+/// @brief Applies an affine transform to all vertices
+/// @param mesh Buffers to be transformed in place
+/// @param matrix Row-major 4x4 matrix, the last row is ignored
+void s21::TransformMesh(mesh_buffers* mesh, const double matrix[16]) {
+  std::vector<double>& positions = mesh->positions;
+  for (size_t i = 0; i + 2 < positions.size(); i += 3) {
+    double x = positions[i], y = positions[i + 1], z = positions[i + 2];
+    positions[i] = matrix[0] * x + matrix[1] * y + matrix[2] * z + matrix[3];
+    positions[i + 1] =
+        matrix[4] * x + matrix[5] * y + matrix[6] * z + matrix[7];
+    positions[i + 2] =
+        matrix[8] * x + matrix[9] * y + matrix[10] * z + matrix[11];
+  }
+}
+
+/// @brief Builds the transform the viewer applies for given parameters: zoom,
+/// then rotation around X, Y and Z axes, then shift
+/// @param zoom Scale factor
+/// @param angles Rotation angles in degrees
+/// @param shift Shift along every axis
+/// @param matrix Resulting row-major 4x4 matrix
+void s21::MakeTransform(double zoom, vertice angles, vertice shift,
+                        double matrix[16]) {
+  double ax = angles.x * Constants::CONVERT_RAD;
+  double ay = angles.y * Constants::CONVERT_RAD;
+  double az = angles.z * Constants::CONVERT_RAD;
+  const double scale[16] = {zoom, 0, 0, 0,  //
+                            0, zoom, 0, 0,  //
+                            0, 0, zoom, 0,  //
+                            0, 0, 0, 1};
+  const double rotate_x[16] = {1, 0, 0, 0,                //
+                               0, cos(ax), -sin(ax), 0,  //
+                               0, sin(ax), cos(ax), 0,   //
+                               0, 0, 0, 1};
+  const double rotate_y[16] = {cos(ay), 0, sin(ay), 0,   //
+                               0, 1, 0, 0,               //
+                               -sin(ay), 0, cos(ay), 0,  //
+                               0, 0, 0, 1};
+  const double rotate_z[16] = {cos(az), -sin(az), 0, 0,  //
+                               sin(az), cos(az), 0, 0,   //
+                               0, 0, 1, 0,               //
+                               0, 0, 0, 1};
+  const double move[16] = {1, 0, 0, shift.x,  //
+                           0, 1, 0, shift.y,  //
+                           0, 0, 1, shift.z,  //
+                           0, 0, 0, 1};
+  for (int i = 0; i < 16; ++i) matrix[i] = scale[i];
+  Then(matrix, rotate_x);
+  Then(matrix, rotate_y);
+  Then(matrix, rotate_z);
+  Then(matrix, move);
+}
+
+/// @brief Writes buffers as .obj text
+/// @param mesh Buffers to be written
+/// @param out Destination string, the text is appended
+void s21::ExportObj(const mesh_buffers& mesh, std::string* out) {
+  char number[128];
+  for (size_t i = 0; i + 2 < mesh.positions.size(); i += 3) {
+    snprintf(number, sizeof(number), "v %.17g %.17g %.17g\n",
+             mesh.positions[i], mesh.positions[i + 1], mesh.positions[i + 2]);
+    out->append(number);
+  }
+  for (size_t face = 0; face + 1 < mesh.face_offsets.size(); ++face) {
+    out->append("f");
+    for (size_t i = mesh.face_offsets[face]; i < mesh.face_offsets[face + 1];
+         ++i) {
+      snprintf(number, sizeof(number), " %lld",
+               (long long)mesh.indices[i] + 1);
+      out->append(number);
+    }
+    out->append("\n");
+  }
+}
+
+/// @brief Saves buffers to an .obj file
+/// @param mesh Buffers to be saved
+/// @param path Destination file path
+/// @return True if the whole file was written
+bool s21::SaveObj(const mesh_buffers& mesh, const char* path) {
+  std::string text;
+  ExportObj(mesh, &text);
+  FILE* f = fopen(path, "w");
+  if (f == NULL) return false;
+  bool result = fwrite(text.data(), 1, text.size(), f) == text.size();
+  return fclose(f) == 0 && result;
+}
@@ -0,0 +1,42 @@
+/**
+ @file viewer_core.h
+ @brief Contains the batch-oriented API of the viewer_core library
+ @details The functions work on contiguous buffers and keep no shared state,
+          so they may be called from many threads at once as long as every
+          thread works with its own mesh_buffers.
+ */
+
+#ifndef VIEWER_CORE_H
+#define VIEWER_CORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "controller.h"
+
+namespace s21 {
+/// @brief A model stored in contiguous buffers
+typedef struct {
+  /// x, y, z of every vertex one after another
+  std::vector<double> positions;
+  /// Vertex indices of all faces one after another, starting from 0
+  std::vector<int64_t> indices;
+  /// Face i uses indices [face_offsets[i]; face_offsets[i + 1])
+  std::vector<size_t> face_offsets;
+  /// Bounding box of the model before it was centered
+  bounding_box source_bounds;
+} mesh_buffers;
+
+bool LoadObj(const char* path, mesh_buffers* mesh);
+bool LoadObjFromMemory(const char* data, size_t size, mesh_buffers* mesh,
+                       size_t memory_limit = 0);
+void TransformMesh(mesh_buffers* mesh, const double matrix[16]);
+void MakeTransform(double zoom, vertice angles, vertice shift,
+                   double matrix[16]);
+void ExportObj(const mesh_buffers& mesh, std::string* out);
+bool SaveObj(const mesh_buffers& mesh, const char* path);
+}  // namespace s21
+
+#endif  // VIEWER_CORE_H
@@ -0,0 +1,151 @@
+/**
+ @file welding.cc
+ @brief Contains the implementation of vertex welding functions
+ */
+
+#include "welding.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <unordered_map>
+
+namespace {
+/// @brief Cell of the spatial hash: a grid cell for welding within an
+/// epsilon, the coordinates' bit patterns for exact welding
+typedef struct {
+  int64_t x;
+  int64_t y;
+  int64_t z;
+} cell;
+
+struct CellHash {
+  size_t operator()(const cell& key) const {
+    uint64_t hash = (uint64_t)key.x * 0x9E3779B97F4A7C15ULL;
+    hash ^= (uint64_t)key.y + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    hash ^= (uint64_t)key.z + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    return (size_t)hash;
+  }
+};
+
+struct CellEqual {
+  bool operator()(const cell& a, const cell& b) const {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+  }
+};
+
+/// Largest grid cell coordinate, neighbours of a clamped cell still fit int64_t
+const double CELL_LIMIT = 4e18;
+
+/// @brief Finds the grid cell coordinate of a finite value, very far cells
+/// are clamped, which only makes them share a cell
+/// @param value Coordinate divided by the cell size
+/// @return Cell coordinate
+int64_t CellCoordinate(double value) {
+  value = floor(value);
+  if (value > CELL_LIMIT) value = CELL_LIMIT;
+  if (value < -CELL_LIMIT) value = -CELL_LIMIT;
+  return (int64_t)value;
+}
+
+/// @brief Finds the cell of a point
+/// @param point A point with finite coordinates
+/// @param epsilon Cell size, 0 for exact welding
+/// @return The cell
+cell CellOf(const s21::vertice& point, double epsilon) {
+  if (epsilon == 0) {
+    // Adding zero turns -0 into 0, they are the same value
+    double x = point.x + 0.0, y = point.y + 0.0, z = point.z + 0.0;
+    cell key;
+    memcpy(&key.x, &x, sizeof(x));
+    memcpy(&key.y, &y, sizeof(y));
+    memcpy(&key.z, &z, sizeof(z));
+    return key;
+  }
+  return {CellCoordinate(point.x / epsilon), CellCoordinate(point.y / epsilon),
+          CellCoordinate(point.z / epsilon)};
+}
+
+/// @brief Checks if two points are to be welded
+/// @param a A point
+/// @param b Another point
+/// @param epsilon Largest distance between welded points
+/// @return True if the points are closer than epsilon or equal
+bool Close(const s21::vertice& a, const s21::vertice& b, double epsilon) {
+  if (epsilon == 0) return a.x == b.x && a.y == b.y && a.z == b.z;
+  double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+  return dx * dx + dy * dy + dz * dz <= epsilon * epsilon;
+}
+}  // namespace
+
+/// @brief Merges equal or close vertices into one and remaps face indices.
+/// Vertices are put into a spatial hash: exact welding hashes coordinates'
+/// values, welding within an epsilon hashes grid cells of that size, so only
+/// the 27 cells around a vertex are searched. A vertex is welded to the first
+/// kept vertex found close to it, so the order of kept vertices is unchanged.
+/// Vertices with NaN or infinite coordinates have no cell and are kept as
+/// they are
+/// @param points Vertices, the kept ones are moved to the front
+/// @param faces Faces, their indices are changed to the kept vertices
+/// @param epsilon Largest distance between welded vertices, 0 welds equal
+/// ones only
+/// @param normals Sums of normals by vertex, empty or as long as points,
+/// the sums of welded vertices are added together
+/// @return Number of removed vertices
+size_t s21::WeldVertices(std::vector<vertice>* points, FaceList* faces,
+                         double epsilon, std::vector<vertice>* normals) {
+  if (!(epsilon >= 0)) return 0;
+  size_t count = points->size();
+  if (normals != nullptr && normals->size() != count) normals = nullptr;
+  std::unordered_map<cell, int64_t, CellHash, CellEqual> heads;
+  heads.reserve(count);
+  // Kept vertices of a cell are chained through next, -1 ends a chain
+  std::vector<int64_t> next;
+  std::vector<int64_t> map(count);
+  size_t kept = 0;
+  int reach = epsilon == 0 ? 0 : 1;
+
+  for (size_t i = 0; i < count; ++i) {
+    vertice point = (*points)[i];
+    bool finite =
+        isfinite(point.x) && isfinite(point.y) && isfinite(point.z);
+    cell home = finite ? CellOf(point, epsilon) : cell{0, 0, 0};
+    int64_t found = -1;
+    for (int dz = -reach; finite && dz <= reach && found < 0; ++dz) {
+      for (int dy = -reach; dy <= reach && found < 0; ++dy) {
+        for (int dx = -reach; dx <= reach && found < 0; ++dx) {
+          auto head = heads.find({home.x + dx, home.y + dy, home.z + dz});
+          if (head == heads.end()) continue;
+          for (int64_t j = head->second; j >= 0 && found < 0; j = next[j])
+            if (Close((*points)[j], point, epsilon)) found = j;
+        }
+      }
+    }
+    if (found >= 0) {
+      map[i] = found;
+      if (normals != nullptr) {
+        (*normals)[found].x += (*normals)[i].x;
+        (*normals)[found].y += (*normals)[i].y;
+        (*normals)[found].z += (*normals)[i].z;
+      }
+      continue;
+    }
+    map[i] = (int64_t)kept;
+    (*points)[kept] = point;
+    if (normals != nullptr) (*normals)[kept] = (*normals)[i];
+    if (finite) {
+      auto head = heads.emplace(home, -1).first;
+      next.push_back(head->second);
+      head->second = (int64_t)kept;
+    } else {
+      next.push_back(-1);
+    }
+    ++kept;
+  }
+
+  points->resize(kept);
+  if (normals != nullptr) normals->resize(kept);
+  faces->Remap(map);
+  return count - kept;
+}
@@ -0,0 +1,20 @@
+/**
+ @file welding.h
+ @brief Contains the declaration of vertex welding functions
+ */
+
+#ifndef WELDING_H
+#define WELDING_H
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "controller.h"
+
+namespace s21 {
+size_t WeldVertices(std::vector<vertice>* points, FaceList* faces,
+                    double epsilon, std::vector<vertice>* normals = nullptr);
+}  // namespace s21
+
+#endif  // WELDING_H
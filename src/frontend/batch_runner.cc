@@ -0,0 +1,318 @@
+/**
+ @file batch_runner.cc
+ @brief This file contains the implementation of BatchRunner functions
+ */
+
+#include "batch_runner.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../backend/brick_file.h"
+#include "gl_renderer.h"
+#include "image_saver.h"
+#include "software_renderer.h"
+
+/// @brief Checks if the program was started in headless batch mode
+/// @param argc Arguments count
+/// @param argv Arguments
+/// @return True if "--batch" is among the arguments
+bool s21::BatchRunner::isBatchMode(int argc, char* argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--batch") == 0) return true;
+  }
+  return false;
+}
+
+/// @brief Runs the whole batch
+/// @param arguments Application arguments
+/// @return Process exit code: 0 if every model was processed, 1 if some
+/// failed, 2 on wrong arguments
+int s21::BatchRunner::run(const QStringList& arguments) {
+  if (!parseArguments(arguments)) return 2;
+
+  QFile statsFile(QDir(m_outDir).filePath("stats.jsonl"));
+  if (!QDir().mkpath(m_outDir) ||
+      !statsFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qCritical() << "Cannot write to" << m_outDir;
+    return 1;
+  }
+  if (m_bricks) return convertFiles(&statsFile);
+
+  QOpenGLContext context;
+  QOffscreenSurface surface;
+  std::unique_ptr<QOpenGLFramebufferObject> fbo;
+  std::unique_ptr<Renderer> renderer;
+  if (!m_software && context.create()) {
+    surface.setFormat(context.format());
+    surface.create();
+    if (context.makeCurrent(&surface)) {
+      fbo = std::make_unique<QOpenGLFramebufferObject>(
+          m_size, m_size, QOpenGLFramebufferObject::CombinedDepthStencil);
+      if (fbo->isValid()) {
+        renderer = std::make_unique<GlRenderer>(nullptr);
+        renderer->initialize();
+      }
+    }
+  }
+  if (!renderer) {
+    if (!m_software) qWarning() << "OpenGL is not available, using software";
+    m_software = true;
+    auto software = std::make_unique<SoftwareRenderer>(nullptr);
+    software->setSize(QSize(m_size, m_size));
+    renderer = std::move(software);
+  }
+
+  int failures = 0;
+  ImageSaver saver;
+  QObject::connect(&saver, &ImageSaver::failed,
+                   [&failures](const QString& file, const QString& error) {
+                     qCritical() << "Failed to save" << file << error;
+                     ++failures;
+                   });
+
+  std::atomic<int> next(0);
+  std::vector<std::thread> workers;
+  m_capacity = 2 * m_jobs;
+  for (int i = 0; i < m_jobs; ++i) {
+    workers.emplace_back(&BatchRunner::loadFiles, this, &next);
+  }
+
+  for (int done = 0; done < m_files.size(); ++done) {
+    LoadedModel model = takeLoaded();
+    QString thumbnail;
+    if (model.loaded) {
+      thumbnail = thumbnailName(model);
+      auto start = std::chrono::steady_clock::now();
+      QImage image = renderThumbnail(renderer.get(), fbo.get(),
+                                     model.controller.get());
+      model.renderMs = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+      saver.save(image, QDir(m_outDir).filePath(thumbnail), "PNG");
+    }
+    if (!model.loaded) ++failures;
+    statsFile.write(QJsonDocument(statistics(model, thumbnail))
+                        .toJson(QJsonDocument::Compact) +
+                    '\n');
+    QCoreApplication::processEvents();
+  }
+
+  for (std::thread& worker : workers) worker.join();
+  while (saver.pending() > 0) {
+    QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+  }
+  // The renderer's programs and buffers and the framebuffer are freed while
+  // their context is still current
+  renderer.reset();
+  fbo.reset();
+  if (QOpenGLContext::currentContext() == &context) context.doneCurrent();
+  return failures == 0 ? 0 : 1;
+}
+
+/// @brief Draws a model and reads the frame back
+/// @param renderer OpenGL or software renderer
+/// @param fbo Framebuffer of the OpenGL renderer, nullptr for the software one
+/// @param controller Controller of the model to be drawn
+/// @return The thumbnail image
+QImage s21::BatchRunner::renderThumbnail(Renderer* renderer,
+                                         QOpenGLFramebufferObject* fbo,
+                                         Controller* controller) {
+  renderer->setController(controller);
+  if (!fbo) {
+    renderer->render();
+    return static_cast<SoftwareRenderer*>(renderer)->image();
+  }
+  fbo->bind();
+  glViewport(0, 0, m_size, m_size);
+  renderer->render();
+  fbo->release();
+  return fbo->toImage();
+}
+
+/// @brief Reads options and input paths
+/// @param arguments Application arguments
+/// @return False if there is nothing to process
+bool s21::BatchRunner::parseArguments(const QStringList& arguments) {
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Writes thumbnails and statistics for OBJ models");
+  parser.addHelpOption();
+  parser.addOption({"batch", "Run without a window."});
+  parser.addOption({"out", "Output directory.", "dir", "thumbnails"});
+  parser.addOption({"size", "Thumbnail size in pixels.", "px",
+                    QString::number(DEFAULT_SIZE)});
+  parser.addOption({"jobs", "Number of loading threads.", "n",
+                    QString::number(QThread::idealThreadCount())});
+  parser.addOption({"renderer", "Thumbnail renderer: gl or software.",
+                    "name", "gl"});
+  parser.addOption({"weld",
+                    "Merge vertices closer than eps, 0 merges equal ones.",
+                    "eps"});
+  parser.addOption({"compact", "Keep positions quantized to 16 bits."});
+  parser.addOption({"reorder", "Reorder faces for the vertex cache."});
+  parser.addOption({"bricks",
+                    "Convert models to brick files instead of rendering."});
+  parser.addOption({"grid", "Bricks per axis of converted models.", "n",
+                    QString::number(BrickFile::DEFAULT_GRID)});
+  parser.addPositionalArgument("paths", "OBJ files or directories.",
+                               "paths...");
+  parser.process(arguments);
+
+  m_outDir = parser.value("out");
+  m_size = std::max(1, parser.value("size").toInt());
+  m_jobs = std::max(1, parser.value("jobs").toInt());
+  m_software = parser.value("renderer") == "software";
+  m_weld = parser.isSet("weld") ? parser.value("weld").toDouble() : -1;
+  m_compact = parser.isSet("compact");
+  m_reorder = parser.isSet("reorder");
+  m_bricks = parser.isSet("bricks");
+  m_grid = std::clamp(parser.value("grid").toInt(), 1, BrickFile::MAX_GRID);
+  collectFiles(parser.positionalArguments());
+  if (m_files.isEmpty()) {
+    qCritical() << "No OBJ files given";
+    return false;
+  }
+  return true;
+}
+
+/// @brief Expands directories into the OBJ files they contain
+/// @param inputs Files and directories from the command line
+void s21::BatchRunner::collectFiles(const QStringList& inputs) {
+  for (const QString& input : inputs) {
+    if (QFileInfo(input).isDir()) {
+      QDirIterator it(input, {"*.obj", "*.OBJ"}, QDir::Files,
+                      QDirIterator::Subdirectories);
+      QStringList found;
+      while (it.hasNext()) found.append(it.next());
+      found.sort();
+      m_files.append(found);
+    } else {
+      m_files.append(input);
+    }
+  }
+}
+
+/// @brief Worker thread: takes the next file, loads it into its own
+/// controller and puts it into the queue, waiting while the queue is full
+/// @param next Index of the next file to be loaded
+void s21::BatchRunner::loadFiles(std::atomic<int>* next) {
+  for (int index = (*next)++; index < m_files.size(); index = (*next)++) {
+    LoadedModel model;
+    model.index = index;
+    model.path = m_files[index];
+    model.renderMs = 0;
+    model.controller = std::make_unique<Controller>(false);
+    model.controller->SetWelding(m_weld);
+    model.controller->SetCompact(m_compact);
+    model.controller->SetReordering(m_reorder);
+
+    auto start = std::chrono::steady_clock::now();
+    model.loaded = model.controller->OpenFile(model.path.toUtf8().constData());
+    model.loadMs = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [this]() { return m_loaded.size() < m_capacity; });
+    m_loaded.push_back(std::move(model));
+    m_changed.notify_all();
+  }
+}
+
+/// @brief Converts every file to a brick file in the output directory. Files
+/// are converted one by one, because conversion streams through the disk and
+/// keeps little in memory, parallel conversions would only compete for it
+/// @param statsFile Destination for a line of JSON statistics per file
+/// @return Process exit code: 0 if every file was converted, 1 otherwise
+int s21::BatchRunner::convertFiles(QFile* statsFile) {
+  int failures = 0;
+  for (const QString& path : m_files) {
+    QString name = QFileInfo(path).completeBaseName() + ".s21b";
+    QByteArray target = QDir(m_outDir).filePath(name).toUtf8();
+    auto start = std::chrono::steady_clock::now();
+    bool built = BrickFile::Build(path.toUtf8().constData(),
+                                  target.constData(), m_grid);
+    QJsonObject stats;
+    stats["file"] = path;
+    if (built) {
+      stats["bricks"] = name;
+      stats["build_ms"] = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+    } else {
+      stats["error"] = "cannot convert file";
+      ++failures;
+    }
+    statsFile->write(QJsonDocument(stats).toJson(QJsonDocument::Compact) +
+                     '\n');
+  }
+  return failures == 0 ? 0 : 1;
+}
+
+/// @brief Takes a loaded model from the queue, waiting for one if needed
+/// @return The loaded model
+s21::BatchRunner::LoadedModel s21::BatchRunner::takeLoaded() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_changed.wait(lock, [this]() { return !m_loaded.empty(); });
+  LoadedModel model = std::move(m_loaded.front());
+  m_loaded.pop_front();
+  m_changed.notify_all();
+  return model;
+}
+
+/// @brief Makes a unique thumbnail file name for a model
+/// @param model The loaded model
+/// @return File name inside the output directory
+QString s21::BatchRunner::thumbnailName(const LoadedModel& model) const {
+  return QString("%1_%2.png")
+      .arg(model.index, 6, 10, QChar('0'))
+      .arg(QFileInfo(model.path).completeBaseName());
+}
+
+/// @brief Collects statistics of a model into a JSON object
+/// @param model The loaded model
+/// @param thumbnail Thumbnail file name, empty if it was not rendered
+/// @return JSON object with counts, bounding box and load time
+QJsonObject s21::BatchRunner::statistics(const LoadedModel& model,
+                                         const QString& thumbnail) const {
+  QJsonObject stats;
+  stats["file"] = model.path;
+  if (!model.loaded) {
+    stats["error"] = "cannot open file";
+    return stats;
+  }
+  bounding_box box = model.controller->GetBoundingBox();
+  stats["vertices"] = (qint64)model.controller->GetVertexCount();
+  stats["faces"] = (qint64)model.controller->GetPolygons()->size();
+  stats["bbox"] = QJsonObject{
+      {"min", QJsonArray{box.min.x, box.min.y, box.min.z}},
+      {"max", QJsonArray{box.max.x, box.max.y, box.max.z}}};
+  if (m_weld >= 0)
+    stats["welded"] = (qint64)model.controller->GetLoadStats().welded;
+  if (m_reorder) {
+    stats["acmr_before"] = model.controller->GetLoadStats().acmr_before;
+    stats["acmr_after"] = model.controller->GetLoadStats().acmr_after;
+  }
+  stats["load_ms"] = model.loadMs;
+  if (!thumbnail.isEmpty()) {
+    stats["thumbnail"] = thumbnail;
+    stats["render_ms"] = model.renderMs;
+    stats["renderer"] = m_software ? "software" : "gl";
+  }
+  return stats;
+}
@@ -0,0 +1,85 @@
+/**
+ @file batch_runner.h
+ @brief This file contains BatchRunner class declaration
+ */
+
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <QFile>
+#include <QImage>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "../backend/controller.h"
+#include "renderer.h"
+
+class QOpenGLFramebufferObject;
+
+namespace s21 {
+/// @class BatchRunner
+/// @brief Headless mode: loads a list or directories of OBJ files in parallel
+/// and writes a thumbnail and a line of JSON statistics for every model, or
+/// converts them to brick files for out-of-core viewing
+/// @details Worker threads parse models into independent controllers, the
+///          main thread renders them into an offscreen framebuffer or with the
+///          software renderer on machines without OpenGL. The queue
+///          between them is bounded, so memory use does not depend on the
+///          number of files.
+class BatchRunner {
+ public:
+  static constexpr int DEFAULT_SIZE = 256;
+
+  BatchRunner() = default;
+  ~BatchRunner() = default;
+
+  static bool isBatchMode(int argc, char* argv[]);
+  int run(const QStringList& arguments);
+
+ private:
+  /// @brief A loaded model waiting to be rendered
+  struct LoadedModel {
+    int index;
+    QString path;
+    bool loaded;
+    double loadMs;
+    double renderMs;
+    std::unique_ptr<Controller> controller;
+  };
+
+  QString m_outDir;
+  int m_size = DEFAULT_SIZE;
+  int m_jobs = 1;
+  bool m_software = false;
+  bool m_bricks = false;
+  int m_grid = 8;
+  double m_weld = -1;
+  bool m_compact = false;
+  bool m_reorder = false;
+  QStringList m_files;
+
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::deque<LoadedModel> m_loaded;
+  size_t m_capacity = 1;
+
+  bool parseArguments(const QStringList& arguments);
+  void collectFiles(const QStringList& inputs);
+  void loadFiles(std::atomic<int>* next);
+  int convertFiles(QFile* statsFile);
+  LoadedModel takeLoaded();
+  QImage renderThumbnail(Renderer* renderer, QOpenGLFramebufferObject* fbo,
+                         Controller* controller);
+  QString thumbnailName(const LoadedModel& model) const;
+  QJsonObject statistics(const LoadedModel& model,
+                         const QString& thumbnail) const;
+};
+}  // namespace s21
+
+#endif  // BATCH_RUNNER_H
@@ -18,7 +18,7 @@ class FileLoader : public QWidget {
   Q_OBJECT
  public:
   explicit FileLoader(QWidget* parent = nullptr,
-                      QString filter = "Model (*.obj)")
+                      QString filter = "Model (*.obj *.s21b)")
       : QWidget(parent), m_fileFilter(filter) {}
   ~FileLoader() = default;
 
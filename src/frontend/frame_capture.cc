@@ -0,0 +1,25 @@
+/**
+ @file frame_capture.cc
+ @brief This file contains the implementation of the widget frame capture
+ */
+
+#include "frame_capture.h"
+
+#include <QPainter>
+
+/// @brief Captures a single frame from a widget
+/// @details Renders widget content into a transparent ARGB32 image buffer of
+///          the given size. The render() method of widget automatically
+///          captures child widgets such as buttons in a given project.
+/// @param widget Widget to be captured
+/// @param size Size of the frame
+/// @return The captured frame
+QImage s21::CaptureWidgetFrame(QWidget* widget, const QSize& size) {
+  QImage frame(size, QImage::Format_ARGB32);
+  frame.fill(Qt::transparent);
+
+  QPainter painter(&frame);
+  widget->render(&painter);
+  painter.end();
+  return frame;
+}
@@ -0,0 +1,17 @@
+/**
+ @file frame_capture.h
+ @brief This file contains the widget frame capture function declaration
+ */
+
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <QImage>
+#include <QSize>
+#include <QWidget>
+
+namespace s21 {
+QImage CaptureWidgetFrame(QWidget* widget, const QSize& size);
+}  // namespace s21
+
+#endif  // FRAME_CAPTURE_H
@@ -6,9 +6,17 @@
 
 #include "frontend.h"
 
+#include <QInputDialog>
+
+#include "tiled_snapshot.h"
+
 s21::View::View(s21::Controller* src, QWidget* parent)
-    : controller(src), QOpenGLWidget(parent) {
+    : controller(src), QOpenGLWidget(parent), renderer(src) {
   CreateFileLoader();
+  CreateHotReloader();
+  CreateBrickPager();
+  CreateImageSaver();
+  turntable = new TurntableRenderer(this, controller);
   CreateButtons();
   CreateControlWidget();
   CreateLabels();
@@ -16,121 +24,20 @@ s21::View::View(s21::Controller* src, QWidget* parent)
   settings->UpdateButtons(controller->GetProjectionMode());
 }
 
-s21::View::~View() { delete settings; }
-
-void s21::View::initializeGL() { initializeOpenGLFunctions(); }
-
-void s21::View::resizeGL(int w, int h) { glViewport(0, 0, w, h); }
-
-/// @brief This function is called every time when widget is updated
-void s21::View::paintGL() {
-  setBackgroundColor();
-
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-  // Set up projection matrix
-  glMatrixMode(GL_PROJECTION);
-
-  // Draw the model
-  drawModel();
-}
-
-/// @brief Draws a model
-void s21::View::drawModel() {
-  if (controller->GetShapeLines() != 2) drawLines();
-  if (controller->GetShapePoints() != 2) drawPoints();
+s21::View::~View() {
+  delete settings;
+  delete turntable;
 }
 
-/// @brief Sets a background color depending on the current color value
-void s21::View::setBackgroundColor() {
-  switch (controller->GetBackgroundColor()) {
-    case 0:
-      glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-      break;
-    case 1:
-      glClearColor(0.1f, 0.1f, 0.3f, 1.0f);
-      break;
-    case 2:
-      glClearColor(0.1f, 0.3f, 0.1f, 1.0f);
-      break;
-  }
+void s21::View::initializeGL() {
+  initializeOpenGLFunctions();
+  renderer.initialize();
 }
 
-/// @brief Draws polygons, using current shape, color, width and projection
-/// values
-void s21::View::drawLines() {
-  int shape = controller->GetShapeLines();
-
-  std::vector<vertice>* points = controller->GetPoints();
-  std::vector<std::vector<int>>* polygons = controller->GetPolygons();
-  int projection_mode = controller->GetProjectionMode();
-
-  int current_color = controller->GetLinesColor();
-  UpdateColor(current_color);
-
-  float lineWidth = controller->GetLineWidth();
-  glLineWidth(lineWidth);
-
-  if (shape == 1) {
-    glEnable(GL_LINE_STIPPLE);
-    glLineStipple(1, 0x3030);
-  }
-
-  for (size_t size = 0; size < polygons->size(); ++size) {
-    glBegin(GL_LINE_LOOP);
-    for (size_t polygon_size = 0; polygon_size < polygons->at(size).size();
-         ++polygon_size) {
-      size_t point_index = polygons->at(size).at(polygon_size);
-      if (point_index < points->size()) {
-        vertice point = points->at(point_index);
-        if (projection_mode) point = CountForCentralProj(point);
-        glVertex3d(point.x, point.y, point.z);
-      }
-    }
-    glEnd();
-  }
-  if (shape == 1) glDisable(GL_LINE_STIPPLE);
-}
-
-/// @brief Draws points, using current shape, color, width and projection values
-void s21::View::drawPoints() {
-  int shape = controller->GetShapePoints();
-
-  std::vector<vertice>* points = controller->GetPoints();
-  int projection_mode = controller->GetProjectionMode();
-
-  int color = controller->GetPointsColor();
-  UpdateColor(color);
-
-  int points_size = controller->GetPointSize();
-
-  if (shape == 1) glEnable(GL_POINT_SMOOTH);
-
-  glPointSize(points_size);
-
-  glBegin(GL_POINTS);
-  for (size_t size = 0; size < points->size(); ++size) {
-    vertice point = points->at(size);
-    if (projection_mode) point = CountForCentralProj(point);
-    glVertex3d(point.x, point.y, point.z);
-  }
-  glEnd();
-
-  if (shape == 1) glDisable(GL_POINT_SMOOTH);
-}
+void s21::View::resizeGL(int w, int h) { glViewport(0, 0, w, h); }
 
-/// @brief Change the current point coordinates to be showed if the central
-/// projection is enabled
-/// @param point The current point
-/// @return Updated with central projection mode point
-s21::vertice s21::View::CountForCentralProj(vertice point) {
-  vertice old_point = point;
-  int view_distance = -5;
-  double divisor = old_point.z + view_distance;
-  point.x = view_distance * old_point.x / divisor;
-  point.y = view_distance * old_point.y / divisor;
-  return point;
-}
+/// @brief This function is called every time when widget is updated
+void s21::View::paintGL() { renderer.render(); }
 
 /// @brief Creates buttons for settings window, saving an image and a file
 /// opening functions
@@ -141,6 +48,10 @@ void s21::View::CreateButtons() {
   openControl = new QPushButton("Settings", menuBar);
   saveAsImage = new QPushButton("Save as...", menuBar);
   openFile = new QPushButton("Open...", menuBar);
+  followFile = new QPushButton("Follow", menuBar);
+  saveAsTurntable = new QPushButton("Turntable...", menuBar);
+  saveAsVideo = new QPushButton("Video...", menuBar);
+  saveAsSnapshot = new QPushButton("Snapshot...", menuBar);
 
   // Set button sizes
   int buttonWidth = 70;   // Width of the buttons
@@ -149,11 +60,19 @@ void s21::View::CreateButtons() {
   openControl->setFixedSize(buttonWidth, buttonHeight);
   saveAsImage->setFixedSize(buttonWidth, buttonHeight);
   openFile->setFixedSize(buttonWidth, buttonHeight);
+  followFile->setFixedSize(buttonWidth, buttonHeight);
+  saveAsTurntable->setFixedSize(buttonWidth, buttonHeight);
+  saveAsVideo->setFixedSize(buttonWidth, buttonHeight);
+  saveAsSnapshot->setFixedSize(buttonWidth, buttonHeight);
 
   menuBar->setLayout(menuBarLayout);
   menuBarLayout->addWidget(openControl);
   menuBarLayout->addWidget(openFile);
+  menuBarLayout->addWidget(followFile);
   menuBarLayout->addWidget(saveAsImage);
+  menuBarLayout->addWidget(saveAsTurntable);
+  menuBarLayout->addWidget(saveAsVideo);
+  menuBarLayout->addWidget(saveAsSnapshot);
 
   connect(openControl, &QPushButton::clicked, [this]() {
     if (settings->isHidden())
@@ -164,12 +83,33 @@ void s21::View::CreateButtons() {
 
   connect(openFile, &QPushButton::clicked, fileLoader, &FileLoader::openFile);
 
+  followFile->setEnabled(false);
+  connect(followFile, &QPushButton::clicked, [this]() { toggleFollowing(); });
+  connect(tailFollower, &TailFollower::stopped, followFile, [this]() {
+    followFile->setText("Follow");
+    hotReloader->setPaused(false);
+  });
+
   connect(saveAsImage, &QPushButton::clicked, [this]() {
     menuBar->hide();
+    saveInfo->hide();
     saveWidgetAsImage();
     menuBar->show();
   });
 
+  connect(saveAsTurntable, &QPushButton::clicked,
+          [this]() { saveTurntable(); });
+
+  connect(saveAsSnapshot, &QPushButton::clicked,
+          [this]() { saveTiledSnapshot(); });
+
+  videoRecorder = new VideoRecorder(this, 25, this);
+
+  connect(saveAsVideo, &QPushButton::clicked,
+          [this]() { toggleVideoRecording(); });
+  connect(videoRecorder, &VideoRecorder::recordingStopped, saveAsVideo,
+          [this]() { saveAsVideo->setText("Video..."); });
+
 #ifdef WITH_GIF_SUPPORT
   saveAsGif = new QPushButton("Record...", menuBar);
   saveAsGif->setFixedSize(buttonWidth, buttonHeight);
@@ -202,6 +142,12 @@ void s21::View::CreateLabels() {
   palette.setColor(QPalette::Window, Qt::white);
   modelInfo->setAutoFillBackground(true);
   modelInfo->setPalette(palette);
+
+  saveInfo = new QLabel(this);
+  saveInfo->move(10, 10);
+  saveInfo->setAutoFillBackground(true);
+  saveInfo->setPalette(palette);
+  saveInfo->hide();
 }
 
 /// @brief Connects all ControlWidget's control elements' signals with
@@ -239,6 +185,36 @@ void s21::View::ConnectControlWidget() {
 
   connect(settings, &ControlWidget::ShapePointsClicked, this,
           &View::onPointsShapeButton);
+
+  connect(settings, &ControlWidget::ShapeFacesClicked, this,
+          &View::onFacesShapeButton);
+
+  connect(settings, &ControlWidget::HiddenLinesClicked, this,
+          &View::onHiddenLinesButton);
+}
+
+/// @brief Creates the background image saver and shows its results
+void s21::View::CreateImageSaver() {
+  imageSaver = new ImageSaver(this);
+  connect(imageSaver, &ImageSaver::saved, this, [this](const QString& file) {
+    showSaveInfo("Saved: " + QFileInfo(file).fileName());
+  });
+  connect(imageSaver, &ImageSaver::failed, this,
+          [this](const QString& file, const QString& error) {
+            showSaveInfo("Failed: " + QFileInfo(file).fileName() + "\n" +
+                         error);
+          });
+}
+
+/// @brief Shows a short message about a saved screenshot for a few seconds
+/// @param text Message to be shown
+void s21::View::showSaveInfo(const QString& text) {
+  saveInfo->setText(text);
+  saveInfo->adjustSize();
+  saveInfo->show();
+  QTimer::singleShot(3000, saveInfo, [this]() {
+    if (imageSaver->pending() == 0) saveInfo->hide();
+  });
 }
 
 /// @brief Creates a fileLoader
@@ -247,6 +223,44 @@ void s21::View::CreateFileLoader() {
   connect(fileLoader, &FileLoader::fileSelected, this, &View::handleFileSelect);
 }
 
+/// @brief Creates a hotReloader, which reloads the opened file when it is
+/// changed on disk, and a tailFollower, which follows a growing file
+void s21::View::CreateHotReloader() {
+  hotReloader = new HotReloader(controller, this);
+  tailFollower = new TailFollower(controller, this);
+  auto onChanged = [this]() {
+    UpdateModelInfo(QFileInfo(hotReloader->file()).fileName());
+    update();
+  };
+  connect(hotReloader, &HotReloader::reloaded, this, onChanged);
+  connect(tailFollower, &TailFollower::updated, this, onChanged);
+}
+
+/// @brief Creates a brickPager, which keeps the bricks of an opened brick
+/// file in line with the view as it is zoomed, rotated and shifted. For .obj
+/// files PageBricks returns false at once
+void s21::View::CreateBrickPager() {
+  brickPager = new QTimer(this);
+  connect(brickPager, &QTimer::timeout, this, [this]() {
+    if (!controller->PageBricks()) return;
+    UpdateModelInfo(QFileInfo(hotReloader->file()).fileName());
+    update();
+  });
+  brickPager->start(PAGING_MS);
+}
+
+/// @brief Starts or stops following the opened file as it grows
+void s21::View::toggleFollowing() {
+  if (tailFollower->isFollowing()) {
+    tailFollower->stop();
+    followFile->setText("Follow");
+    hotReloader->setPaused(false);
+  } else if (tailFollower->start(hotReloader->file())) {
+    followFile->setText("Unfollow");
+    hotReloader->setPaused(true);
+  }
+}
+
 /// @brief A slot which is called when rotation around X axis is changed
 /// @param value A changed angle value
 void s21::View::onXRotationChanged(int value) {
@@ -318,7 +332,6 @@ void s21::View::onPointColorButton() {
 /// @brief A slot which is called when background color button is pushed
 void s21::View::onBackgroundColorButton() {
   controller->ChangeBackgroundColor();
-  setBackgroundColor();
   update();
 }
 
@@ -346,6 +359,20 @@ void s21::View::onPointsShapeButton() {
   update();
 }
 
+/// @brief A slot which is called when faces shape button is pushed: faces
+/// are hidden, flat shaded or smooth shaded
+void s21::View::onFacesShapeButton() {
+  controller->ChangeFacesShape();
+  update();
+}
+
+/// @brief A slot which is called when hidden lines button is pushed: lines
+/// behind faces are removed or drawn again
+void s21::View::onHiddenLinesButton() {
+  controller->ChangeHiddenLines();
+  update();
+}
+
 s21::ControlWidget::ControlWidget(QWidget* parent) { CreateControlElements(); }
 
 /// @brief Creates all control elements on the settings window
@@ -470,6 +497,14 @@ void s21::ControlWidget::CreateShapeSettings() {
   shapePoints->setFixedSize(80, 25);
   shapeLayout->addWidget(shapePoints);
 
+  shapeFaces = new QPushButton("Faces", this);
+  shapeFaces->setFixedSize(80, 25);
+  shapeLayout->addWidget(shapeFaces);
+
+  hiddenLines = new QPushButton("Hidden lines", this);
+  hiddenLines->setFixedSize(80, 25);
+  shapeLayout->addWidget(hiddenLines);
+
   mainLayout->addWidget(shapeGroup);
 }
 
@@ -513,6 +548,12 @@ void s21::ControlWidget::ConnectControlElements() {
 
   connect(shapePoints, &QPushButton::clicked, this,
           &ControlWidget::ShapePointsClicked);
+
+  connect(shapeFaces, &QPushButton::clicked, this,
+          &ControlWidget::ShapeFacesClicked);
+
+  connect(hiddenLines, &QPushButton::clicked, this,
+          &ControlWidget::HiddenLinesClicked);
 }
 
 /// @brief Updates the projection button label
@@ -544,55 +585,39 @@ void s21::ControlWidget::ResetParams() {
 /// @param fileName Just a name of the file
 void s21::View::handleFileSelect(const QString& filePath,
                                  const QString& fileName) {
-  const char* cstrPath = filePath.toUtf8().constData();
-  controller->OpenFile(cstrPath);
+  QByteArray path = filePath.toUtf8();
+  if (!controller->OpenFile(path.constData())) {
+    load_stats stats = controller->GetLoadStats();
+    if (stats.refused)
+      showSaveInfo(QString::asprintf("Too large: %zu MB needed",
+                                     stats.expected_bytes >> 20));
+    else
+      showSaveInfo("Cannot open: " + fileName);
+    return;
+  }
   UpdateModelInfo(fileName);
   controller->ResetParams();
   settings->ResetParams();
   this->update();
+  if (tailFollower->isFollowing()) toggleFollowing();
+  hotReloader->watch(filePath);
+  followFile->setEnabled(true);
+  emit modelOpened(filePath);
 }
 
 /// @brief Updates the label describing the current model
 /// @param file Current model's filename
 void s21::View::UpdateModelInfo(QString file) {
   modelInfo->setText(QString::asprintf("Vertexes: %d\nPolygons: %d\nFile: ",
-                                       (int)controller->GetPoints()->size(),
+                                       (int)controller->GetVertexCount(),
                                        (int)controller->GetPolygons()->size()) +
                      file);
 }
 
-/// @brief Updates the points/lines color depending on current color values for
-/// points/polygons
-/// @param LineColor The current color value
-void s21::View::UpdateColor(int LineColor) {
-  switch (LineColor) {
-    case 0:
-      glColor3d(1, 1, 1);
-      break;
-    case 1:
-      glColor3d(1, 0, 0);
-      break;
-    case 2:
-      glColor3d(1, 1, 0);
-      break;
-    case 3:
-      glColor3d(0, 1, 1);
-      break;
-    case 4:
-      glColor3d(0, 1, 0);
-      break;
-    case 5:
-      glColor3d(0, 0, 1);
-      break;
-    case 6:
-      glColor3d(1, 0, 1);
-      break;
-  }
-}
-
-/// @brief Saves a screenshot of the widget
+/// @brief Captures a screenshot of the widget and hands it to the background
+/// image saver
 void s21::View::saveWidgetAsImage() {
-  QPixmap pixmap = this->grab();
+  QImage image = this->grab().toImage();
   QString filter = "JPEG Files (*.jpeg);;PNG Files (*.png);;BMP Files (*.bmp)";
   QString selectedFormat;
   QString fileName = QFileDialog::getSaveFileName(this, "Save Image", "",
@@ -620,10 +645,61 @@ void s21::View::saveWidgetAsImage() {
       selectedFormat = "PNG";  // or another case
     }
 
-    if (pixmap.save(fileName, selectedFormat.toStdString().c_str())) {
-      // qDebug() << "Image saved successfuly";
-    } else {
-      // qDebug() << "Error! Failed to save image";
+    imageSaver->save(image, fileName, selectedFormat);
+  }
+}
+
+/// @brief Renders a turntable of the current model into a chosen directory
+void s21::View::saveTurntable() {
+  QString dirPath = QFileDialog::getExistingDirectory(
+      this, "Save turntable frames", QDir::homePath());
+  if (!dirPath.isEmpty()) {
+    if (turntable->renderToDirectory(dirPath))
+      showSaveInfo("Saved: " + QDir(dirPath).dirName());
+    else
+      showSaveInfo("Failed: " + QDir(dirPath).dirName());
+  }
+}
+
+/// @brief Renders the current view into a high resolution PNG file
+void s21::View::saveTiledSnapshot() {
+  bool accepted = false;
+  int side = QInputDialog::getInt(this, "Snapshot", "Image size, px:",
+                                  TiledSnapshot::DEFAULT_SIZE, width(),
+                                  TiledSnapshot::MAX_SIZE, 1, &accepted);
+  if (!accepted) return;
+  QString fileName = QFileDialog::getSaveFileName(this, "Save Snapshot", "",
+                                                  "PNG Files (*.png)");
+  if (!fileName.isEmpty()) {
+    if (!fileName.endsWith(".png", Qt::CaseInsensitive)) fileName += ".png";
+    TiledSnapshot snapshot(this);
+    if (snapshot.render(fileName, QSize(side, side)))
+      showSaveInfo("Saved: " + QFileInfo(fileName).fileName());
+    else
+      showSaveInfo("Failed: " + QFileInfo(fileName).fileName());
+    update();
+  }
+}
+
+/// @brief Starts recording the widget to a Y4M or APNG file or stops the
+/// current recording
+void s21::View::toggleVideoRecording() {
+  if (videoRecorder->isRecording()) {
+    videoRecorder->stopRecording();
+    return;
+  }
+  QString filter = "Y4M Video (*.y4m);;Animated PNG (*.png)";
+  QString selectedFormat;
+  QString fileName = QFileDialog::getSaveFileName(this, "Record Video", "",
+                                                  filter, &selectedFormat);
+  if (!fileName.isEmpty()) {
+    if (selectedFormat.startsWith("Y4M") &&
+        !fileName.endsWith(".y4m", Qt::CaseInsensitive)) {
+      fileName += ".y4m";
+    } else if (selectedFormat.startsWith("Animated") &&
+               !fileName.endsWith(".png", Qt::CaseInsensitive)) {
+      fileName += ".png";
     }
+    if (videoRecorder->startRecording(fileName)) saveAsVideo->setText("Stop");
   }
 }
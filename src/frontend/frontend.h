@@ -14,12 +14,19 @@
 #include <QPushButton>
 #include <QSlider>
 #include <QSpinBox>
+#include <QTimer>
 #include <QVBoxLayout>
 
 #include "../backend/constants.h"
 #include "../backend/controller.h"
 #include "file_loader.h"
+#include "gl_renderer.h"
+#include "hot_reloader.h"
+#include "image_saver.h"
 #include "range_input.h"
+#include "tail_follower.h"
+#include "turntable_renderer.h"
+#include "video_recorder.h"
 
 #ifdef WITH_GIF_SUPPORT
 #include "gif_recorder.h"
@@ -69,6 +76,8 @@ class ControlWidget : public QWidget {
   QHBoxLayout* shapeLayout;
   QPushButton* shapeLines;
   QPushButton* shapePoints;
+  QPushButton* shapeFaces;
+  QPushButton* hiddenLines;
 
   void CreateControlElements();
 
@@ -104,6 +113,8 @@ class ControlWidget : public QWidget {
   void SizeLinesClicked();
   void SizePointsClicked();
   void ShapePointsClicked();
+  void ShapeFacesClicked();
+  void HiddenLinesClicked();
 };
 
 /// @brief A class that implements the main window with a model view
@@ -119,36 +130,60 @@ class View : public QOpenGLWidget, protected QOpenGLFunctions {
   void paintGL() override;
   void closeEvent(QCloseEvent* event) override { settings->close(); }
   void UpdateModelInfo(QString file);
-  void UpdateColor(int line_color);
-  void drawModel();
-  void setBackgroundColor();
 
-  void drawLines();
-  void drawPoints();
+  /// @brief Sets a multiplier for line widths and point sizes, used when the
+  /// view is rendered at a resolution higher than the widget's one
+  /// @param scale Multiplier, 1 for the widget itself
+  void setPixelScale(float scale) { renderer.setPixelScale(scale); }
+
+  /// How often the bricks of an opened brick file are chosen for the view
+  static constexpr int PAGING_MS = 100;
+
+ signals:
+  void modelOpened(const QString& filePath);
 
  private:
   s21::Controller* controller;
+  GlRenderer renderer;
 
   QLabel* modelInfo;
+  QLabel* saveInfo;
   QWidget* menuBar;
   QPushButton* openControl;
   QPushButton* openFile;
+  QPushButton* followFile;
   QPushButton* saveAsImage;
+  QPushButton* saveAsTurntable;
+  QPushButton* saveAsVideo;
+  QPushButton* saveAsSnapshot;
   s21::ControlWidget* settings;
   FileLoader* fileLoader;
+  HotReloader* hotReloader;
+  TailFollower* tailFollower;
+  QTimer* brickPager;
+  ImageSaver* imageSaver;
+  TurntableRenderer* turntable;
+  VideoRecorder* videoRecorder;
 
 #ifdef WITH_GIF_SUPPORT
   QPushButton* saveAsGif;
   GifRecorder* gifRecorder;
 #endif
 
-  vertice CountForCentralProj(vertice point);
   void CreateButtons();
   void CreateControlWidget();
   void CreateLabels();
   void CreateFileLoader();
+  void CreateHotReloader();
+  void CreateBrickPager();
+  void CreateImageSaver();
   void ConnectControlWidget();
   void saveWidgetAsImage();
+  void showSaveInfo(const QString& text);
+  void saveTurntable();
+  void toggleVideoRecording();
+  void toggleFollowing();
+  void saveTiledSnapshot();
 
  private slots:
   void onXRotationChanged(int value);
@@ -166,6 +201,8 @@ class View : public QOpenGLWidget, protected QOpenGLFunctions {
   void onSizeLineButton();
   void onSizePointsButton();
   void onPointsShapeButton();
+  void onFacesShapeButton();
+  void onHiddenLinesButton();
 
   void handleFileSelect(const QString& filePath, const QString& fileName);
 };
@@ -5,6 +5,8 @@
 
 #include "gif_recorder.h"
 
+#include "frame_capture.h"
+
 /// @brief Constructs GIF recorder and connects frame capture signal
 /// @param targetWidget Widget to record
 /// @param fps Frame rate
@@ -49,20 +51,12 @@ void s21::GifRecorder::stopRecording() {
 }
 
 /// @brief Captures a single frame from the target widget
-/// @details Renders widget content transparent ARGB32 image buffer
-///          with fixed size (640x480) and stores it in frames collection.
-///          The render() method of widget automatically captures child widgets
-///          such as buttons in a given project.
+/// @details Uses the shared widget capture path with fixed size (640x480) and
+///          stores the frame in frames collection.
 void s21::GifRecorder::captureFrame() {
   if (!m_widget) return;
 
-  QImage frame(QSize(WIDTH, HEIGHT), QImage::Format_ARGB32);
-  frame.fill(Qt::transparent);
-
-  QPainter painter(&frame);
-  m_widget->render(&painter);
-  painter.end();
-  m_frames.push_back(frame);
+  m_frames.push_back(CaptureWidgetFrame(m_widget, QSize(WIDTH, HEIGHT)));
 }
 
 /// @brief Creates optimazed 256-color map for GIF encoding
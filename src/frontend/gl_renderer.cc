@@ -0,0 +1,687 @@
+/**
+ @file gl_renderer.cc
+ @brief This file contains the implementation of all GlRenderer functions
+ */
+
+#include "gl_renderer.h"
+
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "../backend/line_strips.h"
+
+#ifndef GL_PRIMITIVE_RESTART
+#define GL_PRIMITIVE_RESTART 0x8F9D
+#endif
+#ifndef GL_VERTEX_PROGRAM_POINT_SIZE
+#define GL_VERTEX_PROGRAM_POINT_SIZE 0x8642
+#endif
+#ifndef GL_POINT_SPRITE
+#define GL_POINT_SPRITE 0x8861
+#endif
+
+namespace {
+/// Passes the fixed-function inputs and the corners' barycentric coordinates
+/// on; GLSL 1.20 works in compatibility contexts of any version
+const char* WIREFRAME_VERTEX = R"(
+#version 120
+attribute vec3 barycentric;
+varying vec3 corner;
+varying vec3 normal;
+void main() {
+  corner = barycentric;
+  normal = gl_Normal;
+  gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+}
+)";
+
+/// Lights a face like the fixed-function faces are, then blends the line
+/// color in by the distance to the nearest edge in pixels. Dashes follow
+/// the 0x3030 stipple along the edge's major axis. With showFaces off only
+/// the lines are painted, their coverage going to alpha
+const char* WIREFRAME_FRAGMENT = R"(
+#version 120
+uniform vec3 lineColor;
+uniform float lineWidth;
+uniform float dashLength;
+uniform bool showFaces;
+uniform bool showLines;
+varying vec3 corner;
+varying vec3 normal;
+void main() {
+  float light = length(normal) > 0.0 ? abs(normalize(normal).z) : 0.0;
+  vec3 face = vec3(0.8) * min(1.0, 0.2 + light);
+  if (!showLines) {
+    gl_FragColor = vec4(face, 1.0);
+    return;
+  }
+  vec3 pixels = corner / max(fwidth(corner), vec3(1e-6));
+  float nearest = min(pixels.x, min(pixels.y, pixels.z));
+  float half_width = 0.5 * lineWidth;
+  float line = 1.0 - smoothstep(half_width - 0.5, half_width + 0.5, nearest);
+  if (dashLength > 0.0 && line > 0.0) {
+    float edge = nearest == pixels.x ? corner.x
+                 : nearest == pixels.y ? corner.y : corner.z;
+    bool vertical = abs(dFdx(edge)) > abs(dFdy(edge));
+    float along = vertical ? gl_FragCoord.y : gl_FragCoord.x;
+    float phase = mod(floor(along / dashLength), 8.0);
+    if (phase < 4.0 || phase >= 6.0) line = 0.0;
+  }
+  if (!showFaces) {
+    if (line <= 0.0) discard;
+    gl_FragColor = vec4(lineColor, line);
+  } else {
+    gl_FragColor = vec4(mix(face, lineColor, line), 1.0);
+  }
+}
+)";
+
+/// Sizes points by the pointSize uniform. Positions are either projected
+/// already, with packedTransform left identity, or packed values, which
+/// packedTransform moves to drawn positions and central projects like
+/// Renderer::CountForCentralProj does
+const char* SPRITE_VERTEX = R"(
+#version 120
+attribute vec3 position;
+uniform mat4 packedTransform;
+uniform bool central;
+uniform float pointSize;
+void main() {
+  vec4 point = packedTransform * vec4(position, 1.0);
+  if (central) point.xy = -5.0 * point.xy / (point.z - 5.0);
+  gl_PointSize = pointSize;
+  gl_Position = gl_ModelViewProjectionMatrix * point;
+}
+)";
+
+/// Paints a square sprite, or cuts a circle out of it when circle is set
+const char* SPRITE_FRAGMENT = R"(
+#version 120
+uniform vec3 pointColor;
+uniform bool circle;
+void main() {
+  vec2 offset = gl_PointCoord - vec2(0.5);
+  if (circle && dot(offset, offset) > 0.25) discard;
+  gl_FragColor = vec4(pointColor, 1.0);
+}
+)";
+
+/// @brief Builds a shader program from GLSL sources
+/// @param context Current context
+/// @param vertex Vertex shader source
+/// @param fragment Fragment shader source
+/// @return The linked program, null if the context can't compile or link it
+std::unique_ptr<QOpenGLShaderProgram> BuildProgram(QOpenGLContext* context,
+                                                   const char* vertex,
+                                                   const char* fragment) {
+  if (context == nullptr || context->isOpenGLES() ||
+      !QOpenGLShaderProgram::hasOpenGLShaderPrograms(context))
+    return nullptr;
+  auto program = std::make_unique<QOpenGLShaderProgram>();
+  // Compatibility contexts draw only while attribute 0 is enabled, programs
+  // reading vertices from their own attribute take it
+  program->bindAttributeLocation("position", 0);
+  if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertex) ||
+      !program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragment) ||
+      !program->link())
+    return nullptr;
+  return program;
+}
+
+/// @brief Turns a normal by a 3x3 row-major matrix
+s21::vertice Rotate(const double m[9], const s21::vertice& normal) {
+  return {m[0] * normal.x + m[1] * normal.y + m[2] * normal.z,
+          m[3] * normal.x + m[4] * normal.y + m[5] * normal.z,
+          m[6] * normal.x + m[7] * normal.y + m[8] * normal.z};
+}
+
+/// @brief Gets a bound buffer ready for an array, keeping what it holds if
+/// the array extends it and fits. A buffer that has to grow for an extended
+/// array is allocated with room for the next extensions
+/// @param buffer A bound buffer
+/// @param capacity Bytes allocated for the buffer, updated
+/// @param from Bytes at the start of the array the buffer holds already
+/// @param bytes Size of the array, at most INT_MAX
+/// @return Bytes at the start that are kept, the rest has to be written
+size_t ResizeBuffer(QOpenGLBuffer* buffer, size_t* capacity, size_t from,
+                    size_t bytes) {
+  if (from > 0 && bytes <= *capacity) return from;
+  *capacity = from == 0 ? bytes
+                        : std::min(std::max(bytes, *capacity * 2),
+                                   (size_t)INT_MAX);
+  buffer->allocate((int)*capacity);
+  return 0;
+}
+}  // namespace
+
+/// @brief Constructs a renderer for a controller's model
+/// @param src Controller providing the model and the view settings
+s21::GlRenderer::GlRenderer(Controller* src) : Renderer(src) {}
+
+/// @brief Resolves OpenGL functions, must be called with a current context.
+/// Primitive restart is core since OpenGL 3.1 but is not a part of
+/// QOpenGLFunctions, so it is looked up separately. Shader programs are
+/// built here too, contexts that can't run them use fixed-function paths
+void s21::GlRenderer::initialize() {
+  initializeOpenGLFunctions();
+  QOpenGLContext* context = QOpenGLContext::currentContext();
+  m_primitiveRestartIndex = nullptr;
+  if (context != nullptr && !context->isOpenGLES() &&
+      context->format().version() >= qMakePair(3, 1))
+    m_primitiveRestartIndex = reinterpret_cast<PrimitiveRestartIndex>(
+        context->getProcAddress("glPrimitiveRestartIndex"));
+
+  m_wireframe = BuildProgram(context, WIREFRAME_VERTEX, WIREFRAME_FRAGMENT);
+  m_sprites = BuildProgram(context, SPRITE_VERTEX, SPRITE_FRAGMENT);
+  m_positionsSnapshot.reset();
+  m_pointBufferSource.reset();
+  m_pointBufferVersion = 0;
+  m_barycentricVersion = 0;
+  if (m_sprites && !m_pointBuffer.isCreated()) {
+    m_pointBuffer.create();
+    m_pointBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+  }
+  if (m_wireframe && !m_barycentricBuffer.isCreated()) {
+    m_barycentricBuffer.create();
+    m_barycentricBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+  }
+}
+
+/// @brief Draws the whole frame into the current framebuffer
+void s21::GlRenderer::render() {
+  setBackgroundColor();
+
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  // Set up projection matrix
+  glMatrixMode(GL_PROJECTION);
+
+  // Draw the model
+  drawModel();
+}
+
+/// @brief Sets a background color depending on the current color value
+void s21::GlRenderer::setBackgroundColor() {
+  QColor color = BackgroundColor(controller->GetBackgroundColor());
+  glClearColor(color.redF(), color.greenF(), color.blueF(), 1.0f);
+}
+
+/// @brief Draws polygons, using current shape, color, width and projection
+/// values, with fixed-function lines: shown faces take their lines along in
+/// drawFacesWithLines unless the context has no shader programs. In hidden
+/// lines mode lines are tested against the faces' depth, without writing
+/// their own
+void s21::GlRenderer::drawLines() {
+  int shape = controller->GetShapeLines();
+  bool hidden = controller->GetHiddenLines() != 0;
+
+  size_t count = CountPoints(*snapshot);
+  const FaceList* polygons = snapshot->polygons.get();
+  int projection_mode = controller->GetProjectionMode();
+
+  int current_color = controller->GetLinesColor();
+  UpdateColor(current_color);
+
+  float lineWidth = controller->GetLineWidth();
+  glLineWidth(lineWidth * pixelScale);
+
+  if (shape == 1) {
+    glEnable(GL_LINE_STIPPLE);
+    glLineStipple(std::max(1, (int)std::lround(pixelScale)), 0x3030);
+  }
+  if (hidden) {
+    beginDepth();
+    glDepthMask(GL_FALSE);
+  }
+
+  bool drawn = drawBatched(count, projection_mode) ||
+               drawIndexed(polygons, count, projection_mode);
+  for (size_t size = 0; !drawn && size < polygons->size(); ++size) {
+    glBegin(GL_LINE_LOOP);
+    for (size_t polygon_size = 0; polygon_size < polygons->at(size).size();
+         ++polygon_size) {
+      size_t point_index = polygons->at(size).at(polygon_size);
+      if (point_index < count) {
+        vertice point = GetPoint(*snapshot, point_index);
+        if (projection_mode) point = CountForCentralProj(point);
+        glVertex3d(point.x, point.y, point.z);
+      }
+    }
+    glEnd();
+  }
+  if (shape == 1) glDisable(GL_LINE_STIPPLE);
+  if (hidden) {
+    glDepthMask(GL_TRUE);
+    endDepth();
+  }
+}
+
+/// @brief Draws the outlines of all faces with one call: the snapshot's line
+/// strips are drawn from a vertex array with primitive restart
+/// @param count Number of vertices
+/// @param projection_mode Central projection if not 0
+/// @return False if nothing was drawn: the context has no primitive restart
+/// (OpenGL 3.1) or the model has no strips
+bool s21::GlRenderer::drawBatched(size_t count, int projection_mode) {
+  const index_stream* strips = snapshot->line_strips.get();
+  if (m_primitiveRestartIndex == nullptr || strips == nullptr) return false;
+
+  fillPositions(count, projection_mode);
+  GLenum type = strips->width == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 0, m_positions.data());
+  glEnable(GL_PRIMITIVE_RESTART);
+  m_primitiveRestartIndex((GLuint)RestartIndex(strips->width));
+  if (strips->count > 0)
+    glDrawElements(GL_LINE_STRIP, (GLsizei)strips->count, type,
+                   strips->indices.data());
+  glDisable(GL_PRIMITIVE_RESTART);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  return true;
+}
+
+/// @brief Puts the drawn positions of all vertices into a vertex array,
+/// unless it holds them already. A version whose points extend the ones it
+/// was filled from gets only the added points
+/// @param count Number of vertices
+/// @param projection_mode Central projection if not 0
+void s21::GlRenderer::fillPositions(size_t count, int projection_mode) {
+  if (m_positionsSnapshot.lock() == snapshot &&
+      m_positionsMode == projection_mode)
+    return;
+  uint64_t version = snapshot->packed ? 0 : snapshot->points.GetVersion();
+  size_t from = 0;
+  if (version != 0 && version == m_positionsVersion &&
+      m_positionsMode == projection_mode)
+    from = std::min(m_positionsCount, count);
+  m_positionsSnapshot = snapshot;
+  m_positionsMode = projection_mode;
+  m_positionsVersion = version;
+  m_positionsCount = count;
+  m_positions.resize(count * 3);
+  for (size_t i = from; i < count; ++i) {
+    vertice point = GetPoint(*snapshot, i);
+    if (projection_mode) point = CountForCentralProj(point);
+    m_positions[i * 3] = (GLfloat)point.x;
+    m_positions[i * 3 + 1] = (GLfloat)point.y;
+    m_positions[i * 3 + 2] = (GLfloat)point.z;
+  }
+}
+
+/// @brief Draws faces from a vertex array, passing the stored 16 or 32-bit
+/// indices to OpenGL as they are
+/// @param polygons Faces of the model
+/// @param count Number of vertices
+/// @param projection_mode Central projection if not 0
+/// @return False if nothing was drawn: OpenGL has no 64-bit index type, and
+/// faces with invalid indices are drawn skipping them by the caller
+bool s21::GlRenderer::drawIndexed(const FaceList* polygons, size_t count,
+                                  int projection_mode) {
+  int width = polygons->GetIndexWidth();
+  if (width == 8 || !polygons->InRange(count)) return false;
+
+  fillPositions(count, projection_mode);
+  GLenum type = width == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 0, m_positions.data());
+  for (FaceView loop : *polygons) {
+    if (loop.size() > 0)
+      glDrawElements(GL_LINE_LOOP, (GLsizei)loop.size(), type, loop.data());
+  }
+  glDisableClientState(GL_VERTEX_ARRAY);
+  return true;
+}
+
+/// @brief Draws filled faces lit by a light at the viewer: flat shading gives
+/// all triangles of a face the face's normal, smooth shading blends vertex
+/// normals. Smooth faces are drawn with the cached triangle indices, flat
+/// ones from a corner array, each with one call. Faces are pushed back in
+/// depth a little, so lines drawn over them stay visible
+void s21::GlRenderer::drawFaces() {
+  const triangle_list* triangles = snapshot->triangles.get();
+  if (triangles == nullptr || snapshot->normals == nullptr ||
+      triangles->indices.count == 0)
+    return;
+
+  beginDepth();
+  glEnable(GL_POLYGON_OFFSET_FILL);
+  glPolygonOffset(1, 1);
+  glEnable(GL_LIGHTING);
+  glEnable(GL_LIGHT0);
+  glEnable(GL_COLOR_MATERIAL);
+  glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+  const GLfloat direction[4] = {0, 0, 1, 0};
+  glLightfv(GL_LIGHT0, GL_POSITION, direction);
+  glColor3d(0.8, 0.8, 0.8);
+  drawTriangles(true, controller->GetShapeFaces() == 1);
+  glDisable(GL_COLOR_MATERIAL);
+  glDisable(GL_LIGHT0);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_POLYGON_OFFSET_FILL);
+  endDepth();
+}
+
+/// @brief Draws lit faces with their outlines in one pass: every corner
+/// carries barycentric coordinates, and the fragment shader colors the
+/// pixels near an edge of the face with the lines' color, width and dashes.
+/// Cuts made inside faces are not outlined. Lines behind faces are hidden
+/// with them, as the depth test sees the faces only. To show them the
+/// program draws the faces alone, then the same corners again in its lines
+/// only mode with the depth test off, so every line is over the faces
+/// @param hidden True to hide lines behind faces
+/// @return False if the program is missing or some faces are not cut into
+/// triangles, having less than three valid vertices, so their lines would
+/// be lost, or the coordinates don't fit a buffer
+bool s21::GlRenderer::drawFacesWithLines(bool hidden) {
+  const triangle_list* triangles = snapshot->triangles.get();
+  const FaceList* polygons = snapshot->polygons.get();
+  if (!m_wireframe || triangles == nullptr || snapshot->normals == nullptr ||
+      triangles->faces.size() + 2 * polygons->size() !=
+          polygons->CountIndices() ||
+      !fillBarycentrics())
+    return false;
+
+  fillCorners(controller->GetShapeFaces() == 1,
+              controller->GetProjectionMode());
+  QColor color = ModelColor(controller->GetLinesColor());
+  float dash = controller->GetShapeLines() == 1
+                   ? std::max(1, (int)std::lround(pixelScale))
+                   : 0;
+
+  beginDepth();
+  m_wireframe->bind();
+  m_wireframe->setUniformValue("lineColor", (GLfloat)color.redF(),
+                               (GLfloat)color.greenF(),
+                               (GLfloat)color.blueF());
+  m_wireframe->setUniformValue(
+      "lineWidth", (GLfloat)(controller->GetLineWidth() * pixelScale));
+  m_wireframe->setUniformValue("dashLength", (GLfloat)dash);
+  m_wireframe->setUniformValue("showFaces", (GLint)1);
+  m_wireframe->setUniformValue("showLines", (GLint)hidden);
+  m_barycentricBuffer.bind();
+  m_wireframe->enableAttributeArray("barycentric");
+  m_wireframe->setAttributeBuffer("barycentric", GL_FLOAT, 0, 3);
+  m_barycentricBuffer.release();
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glVertexPointer(3, GL_DOUBLE, 0, m_cornerPositions.data());
+  glNormalPointer(GL_DOUBLE, 0, m_cornerNormals.data());
+  glDrawArrays(GL_TRIANGLES, 0, (GLsizei)triangles->indices.count);
+  endDepth();
+  if (!hidden) {
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    m_wireframe->setUniformValue("showFaces", (GLint)0);
+    m_wireframe->setUniformValue("showLines", (GLint)1);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)triangles->indices.count);
+    glDisable(GL_BLEND);
+  }
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  m_wireframe->disableAttributeArray("barycentric");
+  m_wireframe->release();
+  return true;
+}
+
+/// @brief Fills the depth buffer with the triangulated faces without
+/// touching the colors. Faces are pushed back in depth a little, so their
+/// own edges pass the depth test, and lines behind them fail it
+void s21::GlRenderer::drawDepth() {
+  const triangle_list* triangles = snapshot->triangles.get();
+  if (triangles == nullptr || snapshot->normals == nullptr ||
+      triangles->indices.count == 0)
+    return;
+
+  beginDepth();
+  glEnable(GL_POLYGON_OFFSET_FILL);
+  glPolygonOffset(1, 1);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  drawTriangles(false, false);
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  glDisable(GL_POLYGON_OFFSET_FILL);
+  endDepth();
+}
+
+/// @brief Draws the snapshot's triangles with one call: with the cached
+/// indices when they fit OpenGL's index types and no face normals are
+/// needed, from a corner array otherwise
+/// @param shaded True to pass normals along
+/// @param flat True to give all corners of a face the face's normal
+void s21::GlRenderer::drawTriangles(bool shaded, bool flat) {
+  const triangle_list& triangles = *snapshot->triangles;
+  size_t count = CountPoints(*snapshot);
+  int projection_mode = controller->GetProjectionMode();
+  int width = triangles.indices.width;
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  if (shaded) glEnableClientState(GL_NORMAL_ARRAY);
+  if (!flat && width != 8) {
+    fillPositions(count, projection_mode);
+    glVertexPointer(3, GL_FLOAT, 0, m_positions.data());
+    if (shaded) {
+      fillNormals(count);
+      glNormalPointer(GL_DOUBLE, 0, m_normals.data());
+    }
+    glDrawElements(GL_TRIANGLES, (GLsizei)triangles.indices.count,
+                   width == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                   triangles.indices.indices.data());
+  } else {
+    fillCorners(flat, projection_mode);
+    glVertexPointer(3, GL_DOUBLE, 0, m_cornerPositions.data());
+    if (shaded) glNormalPointer(GL_DOUBLE, 0, m_cornerNormals.data());
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)triangles.indices.count);
+  }
+  if (shaded) glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+/// @brief Turns the depth test on for faces and the lines over them
+void s21::GlRenderer::beginDepth() {
+  glEnable(GL_DEPTH_TEST);
+  // Points nearer to the viewer have larger z
+  glDepthRange(1, 0);
+  glDepthFunc(GL_LEQUAL);
+}
+
+/// @brief Turns the depth test off, points and lines are drawn without it
+void s21::GlRenderer::endDepth() {
+  glDepthFunc(GL_LESS);
+  glDepthRange(0, 1);
+  glDisable(GL_DEPTH_TEST);
+}
+
+/// @brief Puts the vertex normals, turned like the vertices, into an array
+/// @param count Number of vertices
+void s21::GlRenderer::fillNormals(size_t count) {
+  const ChunkedArray<vertice>& normals = snapshot->normals->vertices;
+  m_normals.resize(count * 3);
+  for (size_t i = 0; i < count && i < normals.size(); ++i) {
+    vertice normal = Rotate(snapshot->normal_rotation, normals[i]);
+    m_normals[i * 3] = normal.x;
+    m_normals[i * 3 + 1] = normal.y;
+    m_normals[i * 3 + 2] = normal.z;
+  }
+}
+
+/// @brief Puts a position and a normal for every triangle corner into
+/// arrays, unless they hold them already
+/// @param flat True to give corners their face's normal instead of their
+/// vertex's one
+/// @param projection_mode Central projection if not 0
+void s21::GlRenderer::fillCorners(bool flat, int projection_mode) {
+  if (m_cornersSnapshot.lock() == snapshot && m_cornersFlat == flat &&
+      m_cornersMode == projection_mode)
+    return;
+  m_cornersSnapshot = snapshot;
+  m_cornersFlat = flat;
+  m_cornersMode = projection_mode;
+  const triangle_list& triangles = *snapshot->triangles;
+  const normal_list& normals = *snapshot->normals;
+  size_t corners = triangles.indices.count;
+  m_cornerPositions.resize(corners * 3);
+  m_cornerNormals.resize(corners * 3);
+  for (size_t i = 0; i < corners; ++i) {
+    int64_t index = ReadIndex(triangles.indices.indices.data(),
+                              triangles.indices.width, i);
+    vertice point = GetPoint(*snapshot, index);
+    if (projection_mode) point = CountForCentralProj(point);
+    vertice normal = flat ? normals.faces[triangles.faces[i / 3]]
+                          : normals.vertices[index];
+    normal = Rotate(snapshot->normal_rotation, normal);
+    m_cornerPositions[i * 3] = point.x;
+    m_cornerPositions[i * 3 + 1] = point.y;
+    m_cornerPositions[i * 3 + 2] = point.z;
+    m_cornerNormals[i * 3] = normal.x;
+    m_cornerNormals[i * 3 + 1] = normal.y;
+    m_cornerNormals[i * 3 + 2] = normal.z;
+  }
+}
+
+/// @brief Puts barycentric coordinates of all triangle corners into the
+/// barycentric buffer, unless it holds them already. Coordinate k is 0 on
+/// the edge opposite corner k, so the smallest one tells the distance to the
+/// nearest edge; for cuts made inside a face it is 1 at all corners, so they
+/// are never the nearest. Triangles appended to the ones it holds are added
+/// at its end
+/// @return False if the coordinates don't fit a buffer
+bool s21::GlRenderer::fillBarycentrics() {
+  const SharedArray<uint8_t>& edges = snapshot->triangles->edges;
+  uint64_t version = edges.GetVersion();
+  if (version == m_barycentricVersion && edges.size() == m_barycentricCount)
+    return true;
+  const size_t triangle_bytes = 9 * sizeof(GLfloat);
+  size_t bytes = edges.size() * triangle_bytes;
+  if (bytes > INT_MAX) return false;
+  size_t from = 0;
+  if (version == m_barycentricVersion)
+    from = std::min(m_barycentricCount, edges.size()) * triangle_bytes;
+  m_barycentricBuffer.bind();
+  from = ResizeBuffer(&m_barycentricBuffer, &m_barycentricBytes, from, bytes);
+  size_t first = from / triangle_bytes;
+  std::vector<GLfloat> coordinates((edges.size() - first) * 9);
+  for (size_t triangle = first; triangle < edges.size(); ++triangle) {
+    for (int corner = 0; corner < 3; ++corner) {
+      GLfloat* corner_coordinates =
+          &coordinates[((triangle - first) * 3 + corner) * 3];
+      for (int k = 0; k < 3; ++k)
+        corner_coordinates[k] =
+            k == corner || !(edges[triangle] >> k & 1) ? 1 : 0;
+    }
+  }
+  if (bytes > from)
+    m_barycentricBuffer.write((int)from, coordinates.data(),
+                              (int)(bytes - from));
+  m_barycentricBuffer.release();
+  m_barycentricVersion = version;
+  m_barycentricCount = edges.size();
+  return true;
+}
+
+/// @brief Puts the points' positions into the point buffer, unless it holds
+/// them already. Packed values are uploaded as they are, once for all
+/// versions of a loaded file, and the sprite program moves them; other
+/// positions are uploaded as projected floats once per version and mode,
+/// and a version extending the uploaded points uploads only the added ones
+/// @param count Number of vertices
+/// @param projection_mode Central projection if not 0
+/// @return False if the positions don't fit a buffer
+bool s21::GlRenderer::fillPointBuffer(size_t count, int projection_mode) {
+  const packed_positions* packed = snapshot->packed.get();
+  std::shared_ptr<const void> source = snapshot->packed;
+  if (!packed) source = snapshot;
+  int mode = packed ? -1 : projection_mode;
+  if (source == m_pointBufferSource.lock() && mode == m_pointBufferMode)
+    return true;
+
+  const size_t point_bytes = 3 * (packed ? sizeof(uint16_t) : sizeof(GLfloat));
+  size_t bytes = count * point_bytes;
+  if (bytes > INT_MAX) return false;
+  uint64_t version = packed ? 0 : snapshot->points.GetVersion();
+  size_t from = 0;
+  if (version != 0 && version == m_pointBufferVersion &&
+      mode == m_pointBufferMode)
+    from = std::min(m_pointBufferCount, count) * point_bytes;
+  if (!packed) fillPositions(count, projection_mode);
+  const char* data = packed ? (const char*)packed->values.data()
+                            : (const char*)m_positions.data();
+  m_pointBuffer.bind();
+  from = ResizeBuffer(&m_pointBuffer, &m_pointBufferBytes, from, bytes);
+  if (bytes > from)
+    m_pointBuffer.write((int)from, data + from, (int)(bytes - from));
+  m_pointBuffer.release();
+  m_pointBufferSource = source;
+  m_pointBufferMode = mode;
+  m_pointBufferVersion = version;
+  m_pointBufferCount = count;
+  return true;
+}
+
+/// @brief Draws points, using current shape, color, width and projection
+/// values, all of them with one call. The positions are kept in a vertex
+/// buffer and the sprite program sizes the points and cuts circles out of
+/// square ones, so no point smoothing is needed. Contexts without the
+/// program draw from a vertex array with fixed-function points
+void s21::GlRenderer::drawPoints() {
+  int shape = controller->GetShapePoints();
+
+  size_t count = CountPoints(*snapshot);
+  int projection_mode = controller->GetProjectionMode();
+
+  int color = controller->GetPointsColor();
+  UpdateColor(color);
+
+  float points_size = controller->GetPointSize() * pixelScale;
+
+  if (m_sprites && fillPointBuffer(count, projection_mode)) {
+    QColor point_color = ModelColor(color);
+    QMatrix4x4 packed_transform;
+    if (snapshot->packed) {
+      const double* m = snapshot->packed_transform;
+      packed_transform = QMatrix4x4(m[0], m[1], m[2], m[3], m[4], m[5], m[6],
+                                    m[7], m[8], m[9], m[10], m[11], 0, 0, 0,
+                                    1);
+    }
+    glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+    glEnable(GL_POINT_SPRITE);
+    m_sprites->bind();
+    m_pointBuffer.bind();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3,
+                          snapshot->packed ? GL_UNSIGNED_SHORT : GL_FLOAT,
+                          GL_FALSE, 0, nullptr);
+    m_sprites->setUniformValue("packedTransform", packed_transform);
+    m_sprites->setUniformValue(
+        "central", (GLint)(snapshot->packed && projection_mode != 0));
+    m_sprites->setUniformValue("pointSize", (GLfloat)points_size);
+    m_sprites->setUniformValue("pointColor", (GLfloat)point_color.redF(),
+                               (GLfloat)point_color.greenF(),
+                               (GLfloat)point_color.blueF());
+    m_sprites->setUniformValue("circle", (GLint)(shape == 1));
+    glDrawArrays(GL_POINTS, 0, (GLsizei)count);
+    glDisableVertexAttribArray(0);
+    m_pointBuffer.release();
+    m_sprites->release();
+    glDisable(GL_POINT_SPRITE);
+    glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+  } else {
+    fillPositions(count, projection_mode);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    if (shape == 1) glEnable(GL_POINT_SMOOTH);
+    glPointSize(points_size);
+    glVertexPointer(3, GL_FLOAT, 0, m_positions.data());
+    glDrawArrays(GL_POINTS, 0, (GLsizei)count);
+    if (shape == 1) glDisable(GL_POINT_SMOOTH);
+    glDisableClientState(GL_VERTEX_ARRAY);
+  }
+}
+
+/// @brief Updates the points/lines color depending on current color values for
+/// points/polygons
+/// @param LineColor The current color value
+void s21::GlRenderer::UpdateColor(int LineColor) {
+  QColor color = ModelColor(LineColor);
+  glColor3d(color.redF(), color.greenF(), color.blueF());
+}
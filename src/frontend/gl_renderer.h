@@ -0,0 +1,105 @@
+/**
+ @file gl_renderer.h
+ @brief This file contains GlRenderer class declaration
+ */
+
+#ifndef GL_RENDERER_H
+#define GL_RENDERER_H
+
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <memory>
+#include <vector>
+
+#include "renderer.h"
+
+namespace s21 {
+/// @brief Draws a controller's model with OpenGL into the current context, used
+/// by the widget as well as by offscreen and headless rendering
+class GlRenderer : public Renderer, protected QOpenGLFunctions {
+ public:
+  explicit GlRenderer(Controller* src);
+
+  void initialize() override;
+  void render() override;
+  void drawLines() override;
+  void drawPoints() override;
+  void drawFaces() override;
+  void drawDepth() override;
+  bool drawFacesWithLines(bool hidden) override;
+  void setBackgroundColor();
+  void UpdateColor(int line_color);
+
+ private:
+  typedef void(QOPENGLF_APIENTRYP PrimitiveRestartIndex)(GLuint index);
+
+  /// Vertices of the current frame, projected, for drawing with indices
+  std::vector<GLfloat> m_positions;
+  /// Version and projection mode m_positions were filled for, lines, faces
+  /// and points of one frame share them. The version is held weakly, so a
+  /// replaced model is freed, or its storage reused by the next load, as
+  /// soon as the frame that drew it is over
+  std::weak_ptr<const geometry> m_positionsSnapshot;
+  int m_positionsMode = 0;
+  /// Version and number of the points m_positions hold, 0 for packed ones.
+  /// Versions share their points' storage while they extend them, so the
+  /// next one can keep the positions filled for these points
+  uint64_t m_positionsVersion = 0;
+  size_t m_positionsCount = 0;
+  /// Normals of the current frame, turned like the vertices
+  std::vector<double> m_normals;
+  /// Triangle corners of the current frame, for flat shading and 64-bit
+  /// indices: positions and normals, one per corner
+  std::vector<double> m_cornerPositions;
+  std::vector<double> m_cornerNormals;
+  /// Version, shading and projection mode the corners were filled for, held
+  /// weakly like m_positionsSnapshot
+  std::weak_ptr<const geometry> m_cornersSnapshot;
+  bool m_cornersFlat = false;
+  int m_cornersMode = 0;
+  /// Barycentric coordinates of triangle corners, with the ones of edges
+  /// that are not faces' edges kept at 1, see fillBarycentrics
+  QOpenGLBuffer m_barycentricBuffer;
+  /// Version and number of the triangle edges m_barycentricBuffer was
+  /// filled for, versions extending them add their own at its end
+  uint64_t m_barycentricVersion = 0;
+  size_t m_barycentricCount = 0;
+  /// Bytes allocated for m_barycentricBuffer
+  size_t m_barycentricBytes = 0;
+  /// Program drawing faces with their outlines, null if shaders don't work
+  std::unique_ptr<QOpenGLShaderProgram> m_wireframe;
+  /// Program drawing points as square or round sprites, null if shaders
+  /// don't work
+  std::unique_ptr<QOpenGLShaderProgram> m_sprites;
+  /// Positions of the points for the sprite program: packed values or
+  /// projected floats
+  QOpenGLBuffer m_pointBuffer;
+  /// What m_pointBuffer holds: the packed values of a loaded file or the
+  /// floats of a version in a projection mode, -1 for packed values. Held
+  /// weakly like m_positionsSnapshot
+  std::weak_ptr<const void> m_pointBufferSource;
+  int m_pointBufferMode = -1;
+  /// Version and number of the points m_pointBuffer holds, like
+  /// m_positionsVersion, and bytes allocated for it
+  uint64_t m_pointBufferVersion = 0;
+  size_t m_pointBufferCount = 0;
+  size_t m_pointBufferBytes = 0;
+  /// glPrimitiveRestartIndex, null if the context doesn't have it
+  PrimitiveRestartIndex m_primitiveRestartIndex = nullptr;
+
+  void fillPositions(size_t count, int projection_mode);
+  void fillNormals(size_t count);
+  void fillCorners(bool flat, int projection_mode);
+  bool fillBarycentrics();
+  bool fillPointBuffer(size_t count, int projection_mode);
+  void drawTriangles(bool shaded, bool flat);
+  void beginDepth();
+  void endDepth();
+  bool drawBatched(size_t count, int projection_mode);
+  bool drawIndexed(const FaceList* polygons, size_t count,
+                   int projection_mode);
+};
+}  // namespace s21
+
+#endif  // GL_RENDERER_H
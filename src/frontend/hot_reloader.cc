@@ -0,0 +1,122 @@
+/**
+ @file hot_reloader.cc
+ @brief This file contains the implementation of HotReloader functions
+ */
+
+#include "hot_reloader.h"
+
+#include <QFileInfo>
+
+/// @brief Constructs a reloader for a controller's model
+/// @param controller Controller of the shown model, used on the GUI thread
+/// only
+/// @param parent Parent QObject
+s21::HotReloader::HotReloader(Controller* controller, QObject* parent)
+    : QObject(parent),
+      m_controller(controller),
+      m_worker(nullptr),
+      m_pending(false),
+      m_paused(false),
+      m_from({-1, ""}),
+      m_appended(false) {
+  m_debounce.setSingleShot(true);
+  m_debounce.setInterval(DEBOUNCE_MS);
+  connect(&m_debounce, &QTimer::timeout, this, &HotReloader::startReload);
+  connect(&m_watcher, &QFileSystemWatcher::fileChanged, this,
+          &HotReloader::onFileChanged);
+  connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this,
+          &HotReloader::onDirectoryChanged);
+}
+
+/// @brief Waits for a running background read
+s21::HotReloader::~HotReloader() {
+  if (m_worker) {
+    m_worker->wait();
+    delete m_worker;
+  }
+}
+
+/// @brief Starts watching a file instead of the previous one
+/// @param filePath Full path of the opened file
+void s21::HotReloader::watch(const QString& filePath) {
+  if (!m_watcher.files().isEmpty()) m_watcher.removePaths(m_watcher.files());
+  if (!m_watcher.directories().isEmpty())
+    m_watcher.removePaths(m_watcher.directories());
+  m_debounce.stop();
+  m_pending = false;
+  m_file = filePath;
+  m_watcher.addPath(filePath);
+  // Tools that replace the file by renaming drop the file watch, the
+  // directory watch notices the new file
+  m_watcher.addPath(QFileInfo(filePath).absolutePath());
+}
+
+/// @brief Schedules a reload, several quick writes cause only one
+/// @param path Changed file
+void s21::HotReloader::onFileChanged(const QString& path) {
+  if (path != m_file) return;
+  if (!m_watcher.files().contains(path) && QFileInfo::exists(path))
+    m_watcher.addPath(path);
+  if (!m_paused) m_debounce.start();
+}
+
+/// @brief Picks up a watched file that was replaced or created again
+/// @param path Changed directory
+void s21::HotReloader::onDirectoryChanged(const QString& path) {
+  Q_UNUSED(path);
+  if (m_file.isEmpty() || m_watcher.files().contains(m_file) ||
+      !QFileInfo::exists(m_file))
+    return;
+  m_watcher.addPath(m_file);
+  if (!m_paused) m_debounce.start();
+}
+
+/// @brief Reads the changed file on a background thread, or marks that one
+/// more read is needed if a read is running
+void s21::HotReloader::startReload() {
+  if (m_worker) {
+    m_pending = true;
+    return;
+  }
+  m_readFile = m_file;
+  m_from = m_controller->GetParsePosition();
+  m_loaded = m_controller->CreateLoader();
+  m_worker = QThread::create([this]() {
+    QByteArray path = m_readFile.toUtf8();
+    m_appended = Controller::ReadTail(path.constData(), m_from, &m_tail);
+    if (!m_appended && !m_loaded->OpenFile(path.constData())) m_loaded.reset();
+  });
+  connect(m_worker, &QThread::finished, this, &HotReloader::onReadFinished);
+  m_worker->start(QThread::LowPriority);
+}
+
+/// @brief Applies the result of a background read to the model, unless
+/// another file was opened or the model changed meanwhile
+void s21::HotReloader::onReadFinished() {
+  m_worker->deleteLater();
+  m_worker = nullptr;
+
+  parse_position current = m_controller->GetParsePosition();
+  bool unchanged =
+      current.offset == m_from.offset && current.check == m_from.check;
+  if (m_readFile != m_file) {
+    // The result belongs to a file that isn't shown any more
+  } else if (!unchanged) {
+    m_pending = true;
+  } else if (m_appended) {
+    if (m_tail.position.offset != m_from.offset) {
+      m_controller->AppendTail(m_tail);
+      emit reloaded(true);
+    }
+  } else if (m_loaded) {
+    m_controller->ReloadFrom(m_loaded.get());
+    emit reloaded(false);
+  }
+  m_tail = obj_tail();
+  m_loaded.reset();
+
+  if (m_pending) {
+    m_pending = false;
+    startReload();
+  }
+}
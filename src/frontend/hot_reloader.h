@@ -0,0 +1,68 @@
+/**
+ @file hot_reloader.h
+ @brief This file contains HotReloader class declaration
+ */
+
+#ifndef HOT_RELOADER_H
+#define HOT_RELOADER_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <memory>
+
+#include "../backend/controller.h"
+
+namespace s21 {
+/// @class HotReloader
+/// @brief Watches the opened file and reloads it in the background when it is
+/// changed on disk, keeping the current zoom, rotation and shift
+/// @details When only records were appended, just the new tail is parsed and
+///          added to the model. Otherwise the file is loaded by a separate
+///          controller and swapped in. The model itself is only changed on
+///          the GUI thread.
+class HotReloader : public QObject {
+  Q_OBJECT
+ public:
+  static constexpr int DEBOUNCE_MS = 200;
+
+  explicit HotReloader(Controller* controller, QObject* parent = nullptr);
+  ~HotReloader();
+
+  void watch(const QString& filePath);
+  const QString& file() const { return m_file; }
+
+  /// @brief Ignores changes while the file is followed by a TailFollower
+  /// @param paused True to ignore changes
+  void setPaused(bool paused) { m_paused = paused; }
+
+ signals:
+  void reloaded(bool appended);
+
+ private slots:
+  void onFileChanged(const QString& path);
+  void onDirectoryChanged(const QString& path);
+  void startReload();
+  void onReadFinished();
+
+ private:
+  Controller* m_controller;
+  QFileSystemWatcher m_watcher;
+  QTimer m_debounce;
+  QString m_file;
+  QThread* m_worker;
+  bool m_pending;
+  bool m_paused;
+
+  // Written by the worker, read after it has finished
+  QString m_readFile;
+  parse_position m_from;
+  bool m_appended;
+  obj_tail m_tail;
+  std::unique_ptr<Controller> m_loaded;
+};
+}  // namespace s21
+
+#endif  // HOT_RELOADER_H
@@ -0,0 +1,62 @@
+/**
+ @file image_saver.cc
+ @brief This file contains the implementation of ImageEncoder and ImageSaver
+ functions
+ */
+
+#include "image_saver.h"
+
+#include <QImageWriter>
+
+/// @brief Writes an image to a file
+/// @param image Image to be saved
+/// @param fileName Destination file path
+/// @param format Image format, e.g. "PNG"
+void s21::ImageEncoder::encode(const QImage& image, const QString& fileName,
+                               const QString& format) {
+  QImageWriter writer(fileName, format.toLatin1());
+  bool success = writer.write(image);
+  emit finished(fileName, success, success ? QString() : writer.errorString());
+}
+
+/// @brief Constructs the saver and starts its worker thread
+/// @param parent Parent QObject
+s21::ImageSaver::ImageSaver(QObject* parent)
+    : QObject(parent), m_encoder(new ImageEncoder), m_pending(0) {
+  m_encoder->moveToThread(&m_thread);
+  connect(this, &ImageSaver::encodeRequested, m_encoder,
+          &ImageEncoder::encode);
+  connect(m_encoder, &ImageEncoder::finished, this, &ImageSaver::onEncoded);
+  m_thread.start(QThread::LowPriority);
+}
+
+/// @brief Finishes all queued images and stops the worker thread
+s21::ImageSaver::~ImageSaver() {
+  QMetaObject::invokeMethod(
+      m_encoder, [this]() { m_thread.quit(); }, Qt::QueuedConnection);
+  m_thread.wait();
+  delete m_encoder;
+}
+
+/// @brief Queues an image to be saved in the background
+/// @param image Captured image, shared with the worker without copying
+/// @param fileName Destination file path
+/// @param format Image format, e.g. "PNG"
+void s21::ImageSaver::save(const QImage& image, const QString& fileName,
+                           const QString& format) {
+  ++m_pending;
+  emit encodeRequested(image, fileName, format);
+}
+
+/// @brief Reports the result of an encoded image
+/// @param fileName Destination file path
+/// @param success True if the image was written
+/// @param error Error description when the image was not written
+void s21::ImageSaver::onEncoded(const QString& fileName, bool success,
+                                const QString& error) {
+  --m_pending;
+  if (success)
+    emit saved(fileName);
+  else
+    emit failed(fileName, error);
+}
@@ -0,0 +1,59 @@
+/**
+ @file image_saver.h
+ @brief This file contains ImageEncoder and ImageSaver classes declaration
+ */
+
+#ifndef IMAGE_SAVER_H
+#define IMAGE_SAVER_H
+
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+namespace s21 {
+/// @class ImageEncoder
+/// @brief Encodes images to files, lives in the ImageSaver worker thread
+class ImageEncoder : public QObject {
+  Q_OBJECT
+ public slots:
+  void encode(const QImage& image, const QString& fileName,
+              const QString& format);
+
+ signals:
+  void finished(const QString& fileName, bool success, const QString& error);
+};
+
+/// @class ImageSaver
+/// @brief Saves images on a background thread so the GUI never waits for
+/// PNG/JPEG/BMP encoding
+/// @details Requests are queued in the worker's event queue and encoded in
+///          the order they were made. All pending images are written before
+///          the saver is destroyed.
+class ImageSaver : public QObject {
+  Q_OBJECT
+ public:
+  explicit ImageSaver(QObject* parent = nullptr);
+  ~ImageSaver();
+
+  void save(const QImage& image, const QString& fileName,
+            const QString& format);
+  int pending() const { return m_pending; }
+
+ signals:
+  void saved(const QString& fileName);
+  void failed(const QString& fileName, const QString& error);
+  void encodeRequested(const QImage& image, const QString& fileName,
+                       const QString& format);
+
+ private slots:
+  void onEncoded(const QString& fileName, bool success, const QString& error);
+
+ private:
+  QThread m_thread;
+  ImageEncoder* m_encoder;
+  int m_pending;
+};
+}  // namespace s21
+
+#endif  // IMAGE_SAVER_H
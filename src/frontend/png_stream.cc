@@ -0,0 +1,164 @@
+/**
+ @file png_stream.cc
+ @brief This file contains the implementation of PngStream functions
+ */
+
+#include "png_stream.h"
+
+#include <cstring>
+
+/// @brief Constructs a stream over an opened device
+/// @param device Writable device, not owned
+s21::PngStream::PngStream(QIODevice* device)
+    : m_device(device),
+      m_width(0),
+      m_deflating(false),
+      m_sequence(nullptr),
+      m_out(CHUNK_SIZE) {
+  std::memset(&m_zstream, 0, sizeof(m_zstream));
+}
+
+/// @brief Releases the compressor if an image was not finished
+s21::PngStream::~PngStream() {
+  if (m_deflating) deflateEnd(&m_zstream);
+}
+
+/// @brief Appends a big-endian 32-bit value
+/// @param data Destination buffer
+/// @param value Value to append
+void s21::PngStream::putUint32(QByteArray& data, uint32_t value) {
+  data.append((char)(value >> 24));
+  data.append((char)(value >> 16));
+  data.append((char)(value >> 8));
+  data.append((char)value);
+}
+
+/// @brief Appends a big-endian 16-bit value
+/// @param data Destination buffer
+/// @param value Value to append
+void s21::PngStream::putUint16(QByteArray& data, uint16_t value) {
+  data.append((char)(value >> 8));
+  data.append((char)value);
+}
+
+/// @brief Writes the PNG file signature
+/// @return True on success
+bool s21::PngStream::writeSignature() {
+  static const char signature[8] = {'\x89', 'P',  'N',    'G',
+                                    '\r',   '\n', '\x1a', '\n'};
+  return m_device->write(signature, 8) == 8;
+}
+
+/// @brief Writes IHDR for an 8-bit RGB image
+/// @param width Image width in pixels
+/// @param height Image height in pixels
+/// @return True on success
+bool s21::PngStream::writeHeader(int width, int height) {
+  m_width = width;
+  QByteArray data;
+  putUint32(data, width);
+  putUint32(data, height);
+  data.append((char)8);  // bit depth
+  data.append((char)2);  // color type: RGB
+  data.append((char)0);  // compression
+  data.append((char)0);  // filter method
+  data.append((char)0);  // no interlace
+  return writeChunk("IHDR", data);
+}
+
+/// @brief Writes a chunk with its length and CRC
+/// @param type Four letters chunk type
+/// @param data Chunk payload
+/// @return True on success
+bool s21::PngStream::writeChunk(const char* type, const QByteArray& data) {
+  QByteArray chunk;
+  chunk.reserve(data.size() + 12);
+  putUint32(chunk, data.size());
+  chunk.append(type, 4);
+  chunk.append(data);
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, (const Bytef*)chunk.constData() + 4, data.size() + 4);
+  putUint32(chunk, crc);
+  return m_device->write(chunk) == chunk.size();
+}
+
+/// @brief Writes the closing IEND chunk
+/// @return True on success
+bool s21::PngStream::writeEnd() { return writeChunk("IEND", QByteArray()); }
+
+/// @brief Starts a new compressed image
+/// @param sequence APNG sequence counter, image data is written to fdAT
+/// chunks when it is given, otherwise to IDAT chunks
+/// @return True on success
+bool s21::PngStream::beginImage(uint32_t* sequence) {
+  if (m_deflating || m_width <= 0) return false;
+  std::memset(&m_zstream, 0, sizeof(m_zstream));
+  if (deflateInit(&m_zstream, Z_DEFAULT_COMPRESSION) != Z_OK) return false;
+  m_deflating = true;
+  m_sequence = sequence;
+  m_row.resize(1 + (size_t)m_width * CHANNELS);
+  m_zstream.next_out = m_out.data();
+  m_zstream.avail_out = m_out.size();
+  return true;
+}
+
+/// @brief Filters and compresses one row of the current image
+/// @param rgb Row of width * 3 bytes
+/// @return True on success
+bool s21::PngStream::writeRow(const uint8_t* rgb) {
+  if (!m_deflating) return false;
+  // Sub filter: every byte is stored as a difference with the previous pixel
+  m_row[0] = 1;
+  size_t size = (size_t)m_width * CHANNELS;
+  for (size_t i = 0; i < size; ++i) {
+    m_row[i + 1] =
+        i < CHANNELS ? rgb[i] : (uint8_t)(rgb[i] - rgb[i - CHANNELS]);
+  }
+  return deflateRow(Z_NO_FLUSH);
+}
+
+/// @brief Finishes the current image and flushes the remaining data
+/// @return True on success
+bool s21::PngStream::endImage() {
+  if (!m_deflating) return false;
+  m_row.clear();
+  bool result = deflateRow(Z_FINISH);
+  deflateEnd(&m_zstream);
+  m_deflating = false;
+  return result;
+}
+
+/// @brief Feeds the row buffer to the compressor and writes full chunks
+/// @param flush zlib flush mode
+/// @return True on success
+bool s21::PngStream::deflateRow(int flush) {
+  m_zstream.next_in = m_row.data();
+  m_zstream.avail_in = m_row.size();
+  int status = Z_OK;
+  do {
+    status = deflate(&m_zstream, flush);
+    if (status == Z_STREAM_ERROR) return false;
+    if (m_zstream.avail_out == 0 ||
+        (status == Z_STREAM_END && m_zstream.avail_out < m_out.size())) {
+      if (!flushData(m_out.size() - m_zstream.avail_out)) return false;
+      m_zstream.next_out = m_out.data();
+      m_zstream.avail_out = m_out.size();
+    }
+  } while (m_zstream.avail_in > 0 ||
+           (flush == Z_FINISH && status != Z_STREAM_END));
+  return true;
+}
+
+/// @brief Writes compressed bytes as an IDAT or fdAT chunk
+/// @param size Number of bytes in the output buffer
+/// @return True on success
+bool s21::PngStream::flushData(size_t size) {
+  QByteArray data;
+  if (m_sequence) {
+    putUint32(data, (*m_sequence)++);
+    data.append((const char*)m_out.data(), size);
+    return writeChunk("fdAT", data);
+  }
+  data = QByteArray::fromRawData((const char*)m_out.data(), size);
+  return writeChunk("IDAT", data);
+}
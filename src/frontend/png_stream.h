@@ -0,0 +1,59 @@
+/**
+ @file png_stream.h
+ @brief This file contains PngStream class declaration
+ */
+
+#ifndef PNG_STREAM_H
+#define PNG_STREAM_H
+
+#include <zlib.h>
+
+#include <QByteArray>
+#include <QIODevice>
+#include <cstdint>
+#include <vector>
+
+namespace s21 {
+/// @class PngStream
+/// @brief Writes PNG chunks and row by row compressed image data to a device
+/// @details Image data is deflated incrementally and flushed to IDAT (or
+///          APNG fdAT) chunks whenever the output buffer fills, so memory use
+///          does not depend on the image size.
+class PngStream {
+ public:
+  explicit PngStream(QIODevice* device);
+  ~PngStream();
+
+  PngStream(const PngStream&) = delete;
+  PngStream& operator=(const PngStream&) = delete;
+
+  bool writeSignature();
+  bool writeHeader(int width, int height);
+  bool writeChunk(const char* type, const QByteArray& data);
+  bool writeEnd();
+
+  bool beginImage(uint32_t* sequence = nullptr);
+  bool writeRow(const uint8_t* rgb);
+  bool endImage();
+
+  static void putUint32(QByteArray& data, uint32_t value);
+  static void putUint16(QByteArray& data, uint16_t value);
+
+ private:
+  static constexpr int CHANNELS = 3;
+  static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+  QIODevice* m_device;
+  int m_width;
+  z_stream m_zstream;
+  bool m_deflating;
+  uint32_t* m_sequence;
+  std::vector<uint8_t> m_row;
+  std::vector<uint8_t> m_out;
+
+  bool deflateRow(int flush);
+  bool flushData(size_t size);
+};
+}  // namespace s21
+
+#endif  // PNG_STREAM_H
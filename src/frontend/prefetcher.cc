@@ -0,0 +1,76 @@
+/**
+ @file prefetcher.cc
+ @brief This file contains the implementation of Prefetcher functions
+ */
+
+#include "prefetcher.h"
+
+#include <QCollator>
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <memory>
+
+#include "../backend/controller.h"
+
+/// @brief Constructs a prefetcher with one low-priority worker thread
+/// @param controller The view's controller, files are loaded the way it
+/// loads them, so the cached models are the ones it would make
+/// @param cache Cache the files are parsed into, shared with the view's
+/// controller
+/// @param parent Parent QObject
+s21::Prefetcher::Prefetcher(Controller* controller, ModelCache* cache,
+                            QObject* parent)
+    : QObject(parent),
+      m_controller(controller),
+      m_cache(cache),
+      m_distance(DEFAULT_DISTANCE) {
+  m_pool.setMaxThreadCount(1);
+  m_pool.setThreadPriority(QThread::LowestPriority);
+}
+
+/// @brief Drops queued jobs and waits for the running one
+s21::Prefetcher::~Prefetcher() {
+  m_pool.clear();
+  m_pool.waitForDone();
+}
+
+/// @brief Lists the .obj files next to a file in natural name order, the
+/// closest ones first, the next file before the previous one
+/// @param filePath Opened file
+/// @param distance How many files to take in each direction
+/// @return Full paths of the neighbouring files
+QStringList s21::Prefetcher::neighbours(const QString& filePath,
+                                        int distance) {
+  QFileInfo info(filePath);
+  QStringList files = info.dir().entryList({"*.obj", "*.OBJ"}, QDir::Files);
+  QCollator collator;
+  collator.setNumericMode(true);
+  std::sort(files.begin(), files.end(), collator);
+
+  QStringList result;
+  qsizetype current = files.indexOf(info.fileName());
+  if (current < 0) return result;
+  for (int step = 1; step <= distance; ++step) {
+    if (current + step < files.size())
+      result << info.dir().filePath(files[current + step]);
+    if (current - step >= 0)
+      result << info.dir().filePath(files[current - step]);
+  }
+  return result;
+}
+
+/// @brief Queues the neighbours of a just opened file, replacing the jobs
+/// queued for the previous one. Loaders are made here, on the view's
+/// thread, with the load settings the view's controller has now
+/// @param filePath Opened file
+void s21::Prefetcher::prefetchNeighbours(const QString& filePath) {
+  m_pool.clear();
+  for (const QString& path : neighbours(filePath, m_distance)) {
+    std::shared_ptr<Controller> loader = m_controller->CreateLoader();
+    loader->SetCache(m_cache);
+    m_pool.start([loader, path]() {
+      loader->Prefetch(path.toUtf8().constData());
+    });
+  }
+}
@@ -0,0 +1,46 @@
+/**
+ @file prefetcher.h
+ @brief This file contains Prefetcher class declaration
+ */
+
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include "../backend/model_cache.h"
+
+namespace s21 {
+/// @class Prefetcher
+/// @brief Parses the files next to the opened one into the model cache on
+/// low-priority background threads, so stepping through a directory of
+/// models has no load wait
+/// @details Only the files within the given distance are queued. Queued jobs
+///          for a previously opened file are dropped, running ones finish.
+class Prefetcher : public QObject {
+  Q_OBJECT
+ public:
+  static constexpr int DEFAULT_DISTANCE = 1;
+
+  Prefetcher(Controller* controller, ModelCache* cache,
+             QObject* parent = nullptr);
+  ~Prefetcher();
+
+  void setDistance(int distance) { m_distance = distance; }
+  static QStringList neighbours(const QString& filePath, int distance);
+
+ public slots:
+  void prefetchNeighbours(const QString& filePath);
+
+ private:
+  Controller* m_controller;
+  ModelCache* m_cache;
+  QThreadPool m_pool;
+  int m_distance;
+};
+}  // namespace s21
+
+#endif  // PREFETCHER_H
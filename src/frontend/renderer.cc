@@ -0,0 +1,75 @@
+/**
+ @file renderer.cc
+ @brief This file contains the implementation of common Renderer functions
+ */
+
+#include "renderer.h"
+
+/// @brief Draws a model, faces, lines and points come from one geometry
+/// version. Shown faces and lines are drawn together when the renderer can,
+/// and apart otherwise. Hidden lines need the faces' depth, which drawn
+/// faces leave, otherwise it is drawn alone
+void s21::Renderer::drawModel() {
+  snapshot = controller->GetSnapshot();
+  bool lines = controller->GetShapeLines() != 2;
+  bool faces = controller->GetShapeFaces() != 0;
+  bool hidden = controller->GetHiddenLines() != 0;
+  if (faces && lines && drawFacesWithLines(hidden))
+    lines = false;
+  else if (faces)
+    drawFaces();
+  else if (lines && hidden)
+    drawDepth();
+  if (lines) drawLines();
+  if (controller->GetShapePoints() != 2) drawPoints();
+  snapshot.reset();
+}
+
+/// @brief Change the current point coordinates to be showed if the central
+/// projection is enabled
+/// @param point The current point
+/// @return Updated with central projection mode point
+s21::vertice s21::Renderer::CountForCentralProj(vertice point) {
+  vertice old_point = point;
+  int view_distance = -5;
+  double divisor = old_point.z + view_distance;
+  point.x = view_distance * old_point.x / divisor;
+  point.y = view_distance * old_point.y / divisor;
+  return point;
+}
+
+/// @brief Returns the points/lines color for a color value
+/// @param color The current color value
+/// @return Color to draw with
+QColor s21::Renderer::ModelColor(int color) {
+  switch (color) {
+    case 1:
+      return QColor::fromRgbF(1, 0, 0);
+    case 2:
+      return QColor::fromRgbF(1, 1, 0);
+    case 3:
+      return QColor::fromRgbF(0, 1, 1);
+    case 4:
+      return QColor::fromRgbF(0, 1, 0);
+    case 5:
+      return QColor::fromRgbF(0, 0, 1);
+    case 6:
+      return QColor::fromRgbF(1, 0, 1);
+    default:
+      return QColor::fromRgbF(1, 1, 1);
+  }
+}
+
+/// @brief Returns the background color for a color value
+/// @param color The current background color value
+/// @return Color to clear with
+QColor s21::Renderer::BackgroundColor(int color) {
+  switch (color) {
+    case 1:
+      return QColor::fromRgbF(0.1f, 0.1f, 0.3f);
+    case 2:
+      return QColor::fromRgbF(0.1f, 0.3f, 0.1f);
+    default:
+      return QColor::fromRgbF(0.0f, 0.0f, 0.0f);
+  }
+}
@@ -0,0 +1,60 @@
+/**
+ @file renderer.h
+ @brief This file contains Renderer class declaration
+ */
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <QColor>
+
+#include "../backend/controller.h"
+
+namespace s21 {
+/// @brief Common interface of the model renderers, the OpenGL one and the
+/// software one are interchangeable for the view, offscreen and headless paths
+class Renderer {
+ public:
+  explicit Renderer(Controller* src) : controller(src), pixelScale(1) {}
+  virtual ~Renderer() = default;
+
+  /// @brief Prepares the renderer, OpenGL needs a current context here
+  virtual void initialize() {}
+  virtual void render() = 0;
+  virtual void drawLines() = 0;
+  virtual void drawPoints() = 0;
+
+  /// @brief Draws filled, lit faces, renderers without shading skip them
+  virtual void drawFaces() {}
+  /// @brief Fills the depth buffer with the model's faces, so lines behind
+  /// them are not drawn, renderers without depth buffer skip it
+  virtual void drawDepth() {}
+  /// @brief Draws faces with their outlines on them in one pass
+  /// @param hidden True to hide lines behind faces, false to show them all
+  /// @return False if the renderer can't, faces and lines are drawn apart
+  virtual bool drawFacesWithLines(bool /*hidden*/) { return false; }
+  void drawModel();
+
+  /// @brief Switches the renderer to another controller's model
+  /// @param src Controller to be drawn
+  void setController(Controller* src) { controller = src; }
+
+  /// @brief Sets a multiplier for line widths and point sizes, used when the
+  /// view is rendered at a resolution higher than the widget's one
+  /// @param scale Multiplier, 1 for the widget itself
+  void setPixelScale(float scale) { pixelScale = scale; }
+
+ protected:
+  Controller* controller;
+  float pixelScale;
+  /// Geometry version drawn by the current frame, taken once per frame so the
+  /// model may be changed by other threads meanwhile
+  geometry_snapshot snapshot;
+
+  static vertice CountForCentralProj(vertice point);
+  static QColor ModelColor(int color);
+  static QColor BackgroundColor(int color);
+};
+}  // namespace s21
+
+#endif  // RENDERER_H
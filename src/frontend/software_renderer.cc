@@ -0,0 +1,359 @@
+/**
+ @file software_renderer.cc
+ @brief This file contains the implementation of SoftwareRenderer functions
+ */
+
+#include "software_renderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "../backend/parallel.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr uint16_t kStipplePattern = 0x3030;
+
+/// @brief Fills n pixels with one color, four at a time with SSE2
+inline void FillSpan(uint32_t* dst, int n, uint32_t color) {
+  int i = 0;
+#ifdef __SSE2__
+  __m128i value = _mm_set1_epi32((int)color);
+  for (; i + 4 <= n; i += 4) _mm_storeu_si128((__m128i*)(dst + i), value);
+#endif
+  for (; i < n; ++i) dst[i] = color;
+}
+
+/// @brief Clips the parametric range of a segment by one box side
+/// (Liang-Barsky)
+template <typename T>
+inline bool ClipSide(T p, T q, T* t0, T* t1) {
+  if (p == 0) return q >= 0;
+  T t = q / p;
+  if (p < 0) {
+    if (t > *t1) return false;
+    if (t > *t0) *t0 = t;
+  } else {
+    if (t < *t0) return false;
+    if (t < *t1) *t1 = t;
+  }
+  return true;
+}
+}  // namespace
+
+/// @brief Constructs a software renderer for a controller's model
+/// @param src Controller providing the model and the view settings
+/// @param threads Number of rasterizing threads, 0 for all hardware threads
+s21::SoftwareRenderer::SoftwareRenderer(Controller* src, int threads)
+    : Renderer(src),
+      m_width(0),
+      m_height(0),
+      m_tilesX(0),
+      m_tilesY(0),
+      m_threads(threads > 0
+                    ? threads
+                    : std::max(1u, std::thread::hardware_concurrency())),
+      m_projected(false) {}
+
+/// @brief Sets the size of the frame
+/// @param size Frame size in pixels
+void s21::SoftwareRenderer::setSize(const QSize& size) {
+  m_width = std::max(0, size.width());
+  m_height = std::max(0, size.height());
+  m_tilesX = (m_width + TILE - 1) / TILE;
+  m_tilesY = (m_height + TILE - 1) / TILE;
+  m_pixels.assign((size_t)m_width * m_height, 0);
+  m_bins.resize((size_t)m_threads * m_tilesX * m_tilesY);
+}
+
+/// @brief Returns a copy of the rendered frame
+/// @return Frame in QImage::Format_RGB32
+QImage s21::SoftwareRenderer::image() const {
+  if (m_pixels.empty()) return QImage();
+  return QImage((const uchar*)m_pixels.data(), m_width, m_height,
+                QImage::Format_RGB32)
+      .copy();
+}
+
+/// @brief Draws the whole frame into the pixel buffer
+void s21::SoftwareRenderer::render() {
+  if (m_pixels.empty()) return;
+  uint32_t background = BackgroundColor(controller->GetBackgroundColor()).rgb();
+  ParallelFor(
+      m_height, m_threads, [this, background](size_t begin, size_t end, int) {
+        FillSpan(m_pixels.data() + begin * m_width, (end - begin) * m_width,
+                 background);
+      });
+  m_projected = false;
+  drawModel();
+}
+
+/// @brief Draws polygons, using current shape, color, width and projection
+/// values
+void s21::SoftwareRenderer::drawLines() {
+  if (m_pixels.empty()) return;
+  project();
+
+  int width = std::max(1, (int)std::lround(controller->GetLineWidth() *
+                                           pixelScale));
+  int stipple = controller->GetShapeLines() == 1
+                    ? std::max(1, (int)std::lround(pixelScale))
+                    : 0;
+  float half = width / 2.0f;
+  int period = 16 * std::max(1, stipple);
+
+  const FaceList* polygons = snapshot->polygons.get();
+  size_t count = m_xs.size();
+  m_edges.clear();
+  for (FaceView loop : *polygons) {
+    int64_t previous = -1;
+    int64_t first = -1;
+    for (int64_t index : loop) {
+      if (index < 0 || (size_t)index >= count) continue;
+      if (previous >= 0) {
+        addEdge(previous, index, half, period);
+      } else {
+        first = index;
+      }
+      previous = index;
+    }
+    if (previous >= 0 && previous != first) {
+      addEdge(previous, first, half, period);
+    }
+  }
+
+  uint32_t color = ModelColor(controller->GetLinesColor()).rgb();
+
+  clearBins();
+  ParallelFor(
+      m_edges.size(), m_threads, [&](size_t begin, size_t end, int thread) {
+        for (size_t i = begin; i < end; ++i) {
+          const Edge& edge = m_edges[i];
+          binBox(thread, i, std::min(edge.x0, edge.x1) - half,
+                 std::min(edge.y0, edge.y1) - half,
+                 std::max(edge.x0, edge.x1) + half,
+                 std::max(edge.y0, edge.y1) + half);
+        }
+      });
+  forEachTile([&](int tile, uint32_t item) {
+    rasterEdge(m_edges[item], tile, width, color, stipple);
+  });
+}
+
+/// @brief Draws points, using current shape, color, width and projection values
+void s21::SoftwareRenderer::drawPoints() {
+  if (m_pixels.empty()) return;
+  project();
+
+  int size = std::max(1, (int)std::lround(controller->GetPointSize() *
+                                          pixelScale));
+  bool round = controller->GetShapePoints() == 1;
+  uint32_t color = ModelColor(controller->GetPointsColor()).rgb();
+  float half = size / 2.0f;
+
+  clearBins();
+  ParallelFor(
+      m_xs.size(), m_threads, [&](size_t begin, size_t end, int thread) {
+        for (size_t i = begin; i < end; ++i) {
+          binBox(thread, i, m_xs[i] - half, m_ys[i] - half, m_xs[i] + half,
+                 m_ys[i] + half);
+        }
+      });
+  forEachTile([&](int tile, uint32_t item) {
+    rasterPoint(m_xs[item], m_ys[item], tile, size, round, color);
+  });
+}
+
+/// @brief Projects all model points to pixel coordinates once per frame
+void s21::SoftwareRenderer::project() {
+  if (m_projected) return;
+  const geometry& model = *snapshot;
+  size_t count = CountPoints(model);
+  bool central = controller->GetProjectionMode();
+  m_xs.resize(count);
+  m_ys.resize(count);
+  float half_width = m_width / 2.0f;
+  float half_height = m_height / 2.0f;
+  ParallelFor(count, m_threads, [&](size_t begin, size_t end, int) {
+    for (size_t i = begin; i < end; ++i) {
+      vertice point = GetPoint(model, i);
+      if (central) point = CountForCentralProj(point);
+      m_xs[i] = (float)(point.x + 1) * half_width;
+      m_ys[i] = (float)(1 - point.y) * half_height;
+    }
+  });
+  m_projected = true;
+}
+
+/// @brief Adds the segment between two projected points, clipped to the
+/// image grown by half a line. Vertices near the eye of the central
+/// projection land very far away or at no finite place at all: segments
+/// with a non-finite end are left out, and clipping keeps the rest small
+/// enough for the pixel coordinates to be cast to int
+/// @param from First point
+/// @param to Second point
+/// @param half Half of the line width in pixels
+/// @param period Stipple pattern length in steps
+void s21::SoftwareRenderer::addEdge(size_t from, size_t to, float half,
+                                    int period) {
+  double x0 = m_xs[from], y0 = m_ys[from], x1 = m_xs[to], y1 = m_ys[to];
+  if (!std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(x1) ||
+      !std::isfinite(y1))
+    return;
+  double dx = x1 - x0;
+  double dy = y1 - y0;
+  double t0 = 0, t1 = 1;
+  if (!ClipSide(-dx, x0 + half, &t0, &t1) ||
+      !ClipSide(dx, m_width + half - x0, &t0, &t1) ||
+      !ClipSide(-dy, y0 + half, &t0, &t1) ||
+      !ClipSide(dy, m_height + half - y0, &t0, &t1))
+    return;
+  // Steps go along the major axis, as in rasterEdge
+  double skipped = t0 * std::max(std::fabs(dx), std::fabs(dy));
+  m_edges.push_back({(float)(x0 + dx * t0), (float)(y0 + dy * t0),
+                     (float)(x0 + dx * t1), (float)(y0 + dy * t1),
+                     (int)std::fmod(skipped, (double)period)});
+}
+
+/// @brief Empties all tile bins, keeping their capacity
+void s21::SoftwareRenderer::clearBins() {
+  for (std::vector<uint32_t>& bin : m_bins) bin.clear();
+}
+
+/// @brief Adds an item to the bins of all tiles its box overlaps
+/// @param thread Binning thread, every thread has its own bins
+/// @param item Index of the edge or point
+/// @param x0 Left side of the box
+/// @param y0 Top side of the box
+/// @param x1 Right side of the box
+/// @param y1 Bottom side of the box
+void s21::SoftwareRenderer::binBox(int thread, uint32_t item, float x0,
+                                   float y0, float x1, float y1) {
+  // NaN fails every comparison, so it is left out too; the box is clamped
+  // to the image before the cast, far points would overflow int
+  if (!(x1 >= 0 && y1 >= 0 && x0 < m_width && y0 < m_height)) return;
+  int tx0 = (int)std::max(x0, 0.0f) / TILE;
+  int ty0 = (int)std::max(y0, 0.0f) / TILE;
+  int tx1 = std::min(m_tilesX - 1, (int)std::min(x1, (float)m_width) / TILE);
+  int ty1 =
+      std::min(m_tilesY - 1, (int)std::min(y1, (float)m_height) / TILE);
+  size_t base = (size_t)thread * m_tilesX * m_tilesY;
+  for (int ty = ty0; ty <= ty1; ++ty) {
+    for (int tx = tx0; tx <= tx1; ++tx) {
+      m_bins[base + ty * m_tilesX + tx].push_back(item);
+    }
+  }
+}
+
+/// @brief Rasterizes tiles in parallel, items of a tile are visited in the
+/// order they were binned, so the result does not depend on threads timing
+/// @param function Called as function(tile, item)
+template <typename Function>
+void s21::SoftwareRenderer::forEachTile(Function function) {
+  int tiles = m_tilesX * m_tilesY;
+  std::atomic<int> next(0);
+  auto work = [&]() {
+    for (int tile = next++; tile < tiles; tile = next++) {
+      for (int thread = 0; thread < m_threads; ++thread) {
+        for (uint32_t item : m_bins[(size_t)thread * tiles + tile]) {
+          function(tile, item);
+        }
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int thread = 1; thread < m_threads; ++thread) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (std::thread& worker : workers) worker.join();
+}
+
+/// @brief Draws the part of a segment that lies inside a tile
+/// @param edge Segment in pixel coordinates
+/// @param tile Tile index
+/// @param width Line width in pixels
+/// @param color Line color
+/// @param stipple Stipple factor, 0 for a solid line
+void s21::SoftwareRenderer::rasterEdge(const Edge& edge, int tile, int width,
+                                       uint32_t color, int stipple) {
+  int left = (tile % m_tilesX) * TILE;
+  int top = (tile / m_tilesX) * TILE;
+  float half = width / 2.0f;
+  float dx = edge.x1 - edge.x0;
+  float dy = edge.y1 - edge.y0;
+  float t0 = 0, t1 = 1;
+  if (!ClipSide(-dx, edge.x0 - (left - half), &t0, &t1) ||
+      !ClipSide(dx, (left + TILE + half) - edge.x0, &t0, &t1) ||
+      !ClipSide(-dy, edge.y0 - (top - half), &t0, &t1) ||
+      !ClipSide(dy, (top + TILE + half) - edge.y0, &t0, &t1))
+    return;
+
+  int steps = std::max(1, (int)std::ceil(std::max(std::fabs(dx),
+                                                  std::fabs(dy))));
+  int first = (int)std::floor(t0 * steps);
+  int last = std::min(steps, (int)std::ceil(t1 * steps));
+  int offset = (width - 1) / 2;
+  for (int step = first; step <= last; ++step) {
+    if (stipple &&
+        !((kStipplePattern >> (((edge.phase + step) / stipple) & 15)) & 1))
+      continue;
+    int x = (int)std::floor(edge.x0 + dx * step / steps) - offset;
+    int y = (int)std::floor(edge.y0 + dy * step / steps) - offset;
+    fillRect(x, y, x + width, y + width, tile, color);
+  }
+}
+
+/// @brief Draws the part of a point that lies inside a tile
+/// @param x Point center x in pixels
+/// @param y Point center y in pixels
+/// @param tile Tile index
+/// @param size Point size in pixels
+/// @param round True for a round point, false for a square one
+/// @param color Point color
+void s21::SoftwareRenderer::rasterPoint(float x, float y, int tile, int size,
+                                        bool round, uint32_t color) {
+  int x0 = (int)std::floor(x) - (size - 1) / 2;
+  int y0 = (int)std::floor(y) - (size - 1) / 2;
+  if (!round) {
+    fillRect(x0, y0, x0 + size, y0 + size, tile, color);
+    return;
+  }
+  float radius = size / 2.0f;
+  float cx = x0 + radius;
+  float cy = y0 + radius;
+  for (int row = 0; row < size; ++row) {
+    float ry = y0 + row + 0.5f - cy;
+    float span = radius * radius - ry * ry;
+    if (span < 0) continue;
+    float half = std::sqrt(span);
+    int from = (int)std::lround(cx - half);
+    int to = (int)std::lround(cx + half);
+    fillRect(from, y0 + row, to, y0 + row + 1, tile, color);
+  }
+}
+
+/// @brief Fills a rectangle clipped to a tile
+/// @param x0 Left side, inclusive
+/// @param y0 Top side, inclusive
+/// @param x1 Right side, exclusive
+/// @param y1 Bottom side, exclusive
+/// @param tile Tile index
+/// @param color Fill color
+void s21::SoftwareRenderer::fillRect(int x0, int y0, int x1, int y1, int tile,
+                                     uint32_t color) {
+  int left = (tile % m_tilesX) * TILE;
+  int top = (tile / m_tilesX) * TILE;
+  x0 = std::max(x0, left);
+  y0 = std::max(y0, top);
+  x1 = std::min({x1, left + TILE, m_width});
+  y1 = std::min({y1, top + TILE, m_height});
+  for (int y = y0; y < y1; ++y) {
+    FillSpan(m_pixels.data() + (size_t)y * m_width + x0, x1 - x0, color);
+  }
+}
@@ -0,0 +1,74 @@
+/**
+ @file software_renderer.h
+ @brief This file contains SoftwareRenderer class declaration
+ */
+
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include <QImage>
+#include <QSize>
+#include <cstdint>
+#include <vector>
+
+#include "renderer.h"
+
+namespace s21 {
+/// @brief Draws a controller's model on the CPU, without OpenGL
+/// @details Vertices are projected once per frame, lines and points are then
+///          sorted into screen tiles and the tiles are rasterized in parallel,
+///          every tile by one thread, so no pixel is shared between threads.
+///          Spans are filled with SSE2 where it is available.
+class SoftwareRenderer : public Renderer {
+ public:
+  static constexpr int TILE = 64;
+
+  explicit SoftwareRenderer(Controller* src, int threads = 0);
+
+  void setSize(const QSize& size);
+  void render() override;
+  void drawLines() override;
+  void drawPoints() override;
+  QImage image() const;
+
+ private:
+  /// @brief A projected line segment in pixel coordinates, clipped to the
+  /// image
+  struct Edge {
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+    /// Stipple steps clipped off before x0, y0, within one pattern period
+    int phase;
+  };
+
+  int m_width;
+  int m_height;
+  int m_tilesX;
+  int m_tilesY;
+  int m_threads;
+  bool m_projected;
+  std::vector<uint32_t> m_pixels;
+  std::vector<float> m_xs;
+  std::vector<float> m_ys;
+  std::vector<Edge> m_edges;
+  std::vector<std::vector<uint32_t>> m_bins;
+
+  void project();
+  void addEdge(size_t from, size_t to, float half, int period);
+  void clearBins();
+  void binBox(int thread, uint32_t item, float x0, float y0, float x1,
+              float y1);
+  template <typename Function>
+  void forEachTile(Function function);
+
+  void rasterEdge(const Edge& edge, int tile, int width, uint32_t color,
+                  int stipple);
+  void rasterPoint(float x, float y, int tile, int size, bool round,
+                   uint32_t color);
+  void fillRect(int x0, int y0, int x1, int y1, int tile, uint32_t color);
+};
+}  // namespace s21
+
+#endif  // SOFTWARE_RENDERER_H
@@ -0,0 +1,90 @@
+/**
+ @file tail_follower.cc
+ @brief This file contains the implementation of TailFollower functions
+ */
+
+#include "tail_follower.h"
+
+/// @brief Constructs a follower for a controller's model
+/// @param controller Controller of the shown model, used on the GUI thread
+/// only
+/// @param parent Parent QObject
+s21::TailFollower::TailFollower(Controller* controller, QObject* parent)
+    : QObject(parent),
+      m_controller(controller),
+      m_worker(nullptr),
+      m_following(false),
+      m_generation(0),
+      m_from({-1, ""}),
+      m_read(false) {
+  m_timer.setInterval(INTERVAL_MS);
+  connect(&m_timer, &QTimer::timeout, this, &TailFollower::poll);
+}
+
+/// @brief Stops following
+s21::TailFollower::~TailFollower() { stop(); }
+
+/// @brief Starts following the file the model was opened from
+/// @param filePath Full path of the opened file
+/// @return False if the file can't be opened
+bool s21::TailFollower::start(const QString& filePath) {
+  stop();
+  if (!m_reader.Open(filePath.toUtf8().constData())) return false;
+  m_following = true;
+  m_timer.start();
+  poll();
+  return true;
+}
+
+/// @brief Stops following and closes the file, waiting for a running read
+void s21::TailFollower::stop() {
+  m_timer.stop();
+  m_following = false;
+  // A finished signal of the stopped read may still be queued, it is ignored
+  ++m_generation;
+  if (m_worker) {
+    m_worker->wait();
+    delete m_worker;
+    m_worker = nullptr;
+  }
+  m_reader.Close();
+}
+
+/// @brief Parses the next chunk on a background thread unless one is being
+/// parsed already
+void s21::TailFollower::poll() {
+  if (m_worker || !m_following) return;
+  m_from = m_controller->GetParsePosition();
+  m_worker = QThread::create(
+      [this]() { m_read = m_reader.Read(m_from, &m_tail); });
+  connect(m_worker, &QThread::finished, this,
+          [this, generation = m_generation]() {
+            if (generation == m_generation) onReadFinished();
+          });
+  m_worker->start(QThread::LowPriority);
+}
+
+/// @brief Appends the parsed chunk to the model and immediately asks for the
+/// next one if the file has more
+void s21::TailFollower::onReadFinished() {
+  m_worker->deleteLater();
+  m_worker = nullptr;
+  if (!m_following) return;
+  if (!m_read) {
+    // Rewritten files are left to the hot reloader
+    stop();
+    emit stopped();
+    return;
+  }
+
+  parse_position current = m_controller->GetParsePosition();
+  long long read = m_tail.position.offset - m_from.offset;
+  if (current.offset == m_from.offset && current.check == m_from.check &&
+      read > 0) {
+    m_controller->AppendTail(m_tail, SLACK);
+    emit updated();
+  }
+  m_tail = obj_tail();
+  if (read >= TailReader::CHUNK_BYTES)
+    QTimer::singleShot(0, this, &TailFollower::poll);
+}
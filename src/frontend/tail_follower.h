@@ -0,0 +1,63 @@
+/**
+ @file tail_follower.h
+ @brief This file contains TailFollower class declaration
+ */
+
+#ifndef TAIL_FOLLOWER_H
+#define TAIL_FOLLOWER_H
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+
+#include "../backend/controller.h"
+#include "../backend/tail_reader.h"
+
+namespace s21 {
+/// @class TailFollower
+/// @brief Follows a growing .obj file like tail -f: the file is kept open and
+/// newly appended records are added to the shown model while it is written
+/// @details Every tick one chunk of at most TailReader::CHUNK_BYTES is parsed
+///          on a background thread and appended on the GUI thread, so the
+///          view keeps a steady frame rate however fast the file grows. The
+///          bounding box is extended incrementally, the model is refitted
+///          only when it outgrows its frame SLACK times.
+class TailFollower : public QObject {
+  Q_OBJECT
+ public:
+  static constexpr int INTERVAL_MS = 40;
+  static constexpr double SLACK = 2;
+
+  explicit TailFollower(Controller* controller, QObject* parent = nullptr);
+  ~TailFollower();
+
+  bool start(const QString& filePath);
+  void stop();
+  bool isFollowing() const { return m_following; }
+
+ signals:
+  void updated();
+  void stopped();
+
+ private slots:
+  void poll();
+
+ private:
+  void onReadFinished();
+
+  Controller* m_controller;
+  QTimer m_timer;
+  TailReader m_reader;
+  QThread* m_worker;
+  bool m_following;
+  int m_generation;
+
+  // Written by the worker, read after it has finished
+  parse_position m_from;
+  bool m_read;
+  obj_tail m_tail;
+};
+}  // namespace s21
+
+#endif  // TAIL_FOLLOWER_H
@@ -0,0 +1,97 @@
+/**
+ @file tiled_snapshot.cc
+ @brief This file contains the implementation of TiledSnapshot functions
+ */
+
+#include "tiled_snapshot.h"
+
+#include <QFile>
+#include <QOpenGLFramebufferObject>
+#include <algorithm>
+#include <vector>
+
+#include "frontend.h"
+#include "png_stream.h"
+
+/// @brief Constructs a tiled snapshot renderer
+/// @param view The view whose OpenGL context and drawing code are used
+/// @param tileSize Side of a square tile in pixels
+s21::TiledSnapshot::TiledSnapshot(View* view, int tileSize)
+    : m_view(view), m_tileSize(tileSize) {}
+
+/// @brief Renders the current view into a PNG file of the given size
+/// @details Line widths and point sizes are scaled with the image, so the
+///          result looks like an enlarged widget
+/// @param filePath Destination PNG file
+/// @param size Size of the whole image in pixels
+/// @return True if the file was written
+bool s21::TiledSnapshot::render(const QString& filePath, const QSize& size) {
+  if (size.isEmpty() || size.width() > MAX_SIZE || size.height() > MAX_SIZE)
+    return false;
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+  PngStream png(&file);
+  bool result = png.writeSignature() &&
+                png.writeHeader(size.width(), size.height()) &&
+                png.beginImage();
+
+  m_view->makeCurrent();
+  QOpenGLFramebufferObject fbo(
+      m_tileSize, m_tileSize, QOpenGLFramebufferObject::CombinedDepthStencil);
+  result = result && fbo.isValid();
+
+  float scale = std::min((float)size.width() / m_view->width(),
+                         (float)size.height() / m_view->height());
+  m_view->setPixelScale(scale);
+
+  size_t stride = (size_t)size.width() * 3;
+  std::vector<uint8_t> strip(stride * m_tileSize);
+  std::vector<uint8_t> tile((size_t)m_tileSize * m_tileSize * 4);
+
+  for (int y0 = 0; y0 < size.height() && result; y0 += m_tileSize) {
+    int th = std::min(m_tileSize, size.height() - y0);
+    for (int x0 = 0; x0 < size.width(); x0 += m_tileSize) {
+      int tw = std::min(m_tileSize, size.width() - x0);
+
+      // The view volume is [-1; 1] on both axes, select the tile's part of it
+      double left = -1.0 + 2.0 * x0 / size.width();
+      double right = -1.0 + 2.0 * (x0 + tw) / size.width();
+      double top = 1.0 - 2.0 * y0 / size.height();
+      double bottom = 1.0 - 2.0 * (y0 + th) / size.height();
+
+      fbo.bind();
+      glViewport(0, 0, tw, th);
+      glMatrixMode(GL_PROJECTION);
+      glLoadIdentity();
+      glOrtho(left, right, bottom, top, 1, -1);
+      m_view->paintGL();
+      glReadPixels(0, 0, tw, th, GL_RGBA, GL_UNSIGNED_BYTE, tile.data());
+      fbo.release();
+
+      // OpenGL rows go bottom to top, the PNG rows go top to bottom
+      for (int row = 0; row < th; ++row) {
+        const uint8_t* src = tile.data() + (size_t)(th - 1 - row) * tw * 4;
+        uint8_t* dst = strip.data() + row * stride + (size_t)x0 * 3;
+        for (int x = 0; x < tw; ++x) {
+          dst[x * 3] = src[x * 4];
+          dst[x * 3 + 1] = src[x * 4 + 1];
+          dst[x * 3 + 2] = src[x * 4 + 2];
+        }
+      }
+    }
+    for (int row = 0; row < th && result; ++row) {
+      result = png.writeRow(strip.data() + row * stride);
+    }
+  }
+
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  m_view->setPixelScale(1);
+  m_view->doneCurrent();
+
+  result = result && png.endImage() && png.writeEnd();
+  file.close();
+  if (!result) file.remove();
+  return result;
+}
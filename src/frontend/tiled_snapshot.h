@@ -0,0 +1,39 @@
+/**
+ @file tiled_snapshot.h
+ @brief This file contains TiledSnapshot class declaration
+ */
+
+#ifndef TILED_SNAPSHOT_H
+#define TILED_SNAPSHOT_H
+
+#include <QSize>
+#include <QString>
+
+namespace s21 {
+class View;
+
+/// @class TiledSnapshot
+/// @brief Renders the current view at a resolution far above the widget size
+/// @details The image is split into tiles, every tile is drawn into an
+///          offscreen framebuffer with a projection that selects its part of
+///          the view volume. Tiles of one row are stitched into a strip that is
+///          compressed to a PNG file at once, so only one strip is kept in
+///          memory.
+class TiledSnapshot {
+ public:
+  static constexpr int DEFAULT_TILE = 1024;
+  static constexpr int DEFAULT_SIZE = 8192;
+  static constexpr int MAX_SIZE = 65536;
+
+  explicit TiledSnapshot(View* view, int tileSize = DEFAULT_TILE);
+  ~TiledSnapshot() = default;
+
+  bool render(const QString& filePath, const QSize& size);
+
+ private:
+  View* m_view;
+  int m_tileSize;
+};
+}  // namespace s21
+
+#endif  // TILED_SNAPSHOT_H
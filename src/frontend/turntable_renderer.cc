@@ -0,0 +1,92 @@
+/**
+ @file turntable_renderer.cc
+ @brief This file contains the implementation of TurntableRenderer functions
+ */
+
+#include "turntable_renderer.h"
+
+#include <QDir>
+#include <QOpenGLFramebufferObject>
+#include <algorithm>
+#include <cmath>
+
+#include "../backend/constants.h"
+#include "frontend.h"
+
+/// @brief Constructs a turntable renderer
+/// @param view The view whose OpenGL context and drawing code are used
+/// @param controller Controller used to rotate the model between frames
+s21::TurntableRenderer::TurntableRenderer(View* view, Controller* controller)
+    : m_view(view), m_controller(controller) {}
+
+/// @brief Renders a full turn around Y axis as fast as the hardware allows
+/// @details Every frame is drawn into an offscreen FBO of the given size, the
+///          rotation is driven through the controller, so the result only
+///          depends on the model and the frame count. The original rotation
+///          is restored at the end.
+/// @param frames Number of frames for the whole turn
+/// @param size Size of every frame in pixels
+/// @param sink Receives the frames in order
+/// @return True if all frames were rendered and accepted by the sink
+bool s21::TurntableRenderer::render(int frames, const QSize& size,
+                                    const FrameSink& sink) {
+  if (frames < 1 || size.isEmpty() || !sink) return false;
+
+  m_view->makeCurrent();
+  QOpenGLFramebufferObject fbo(
+      size, QOpenGLFramebufferObject::CombinedDepthStencil);
+  if (!fbo.isValid()) {
+    m_view->doneCurrent();
+    return false;
+  }
+
+  m_view->setPixelScale(std::min((float)size.width() / m_view->width(),
+                                 (float)size.height() / m_view->height()));
+
+  int start = (int)m_controller->GetRotation().y;
+  bool result = true;
+  for (int index = 0; index < frames && result; ++index) {
+    int angle = frameAngle(start, index, frames);
+    m_controller->RotateY(angle - (int)m_controller->GetRotation().y);
+
+    fbo.bind();
+    glViewport(0, 0, size.width(), size.height());
+    m_view->paintGL();
+    fbo.release();
+
+    result = sink(fbo.toImage(), index);
+  }
+  m_controller->RotateY(start - (int)m_controller->GetRotation().y);
+
+  m_view->setPixelScale(1);
+  m_view->doneCurrent();
+  m_view->update();
+  return result;
+}
+
+/// @brief Renders a turn and saves it as a numbered PNG sequence
+/// @param dirPath Destination directory, created if missing
+/// @param frames Number of frames for the whole turn
+/// @param size Size of every frame in pixels
+/// @return True if every frame was saved
+bool s21::TurntableRenderer::renderToDirectory(const QString& dirPath,
+                                               int frames, const QSize& size) {
+  QDir dir(dirPath);
+  if (!dir.exists() && !dir.mkpath(".")) return false;
+  return render(frames, size, [&dir](const QImage& frame, int index) {
+    return frame.save(dir.filePath(QString::asprintf("frame_%04d.png", index)),
+                      "PNG");
+  });
+}
+
+/// @brief Counts the Y angle of a frame, wrapped to the model's angle range
+/// @param start Rotation of the first frame
+/// @param index Frame number
+/// @param frames Number of frames for the whole turn
+/// @return Angle in degrees
+int s21::TurntableRenderer::frameAngle(int start, int index, int frames) {
+  int angle = start + (int)std::lround(index * 360.0 / frames);
+  while (angle > Constants::MAX_ANGLE) angle -= 360;
+  while (angle < Constants::MIN_ANGLE) angle += 360;
+  return angle;
+}
@@ -0,0 +1,47 @@
+/**
+ @file turntable_renderer.h
+ @brief This file contains TurntableRenderer class declaration
+ */
+
+#ifndef TURNTABLE_RENDERER_H
+#define TURNTABLE_RENDERER_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <functional>
+
+#include "../backend/controller.h"
+
+namespace s21 {
+class View;
+
+/// @class TurntableRenderer
+/// @brief Renders a full turn of the current model frame by frame into an
+/// offscreen framebuffer, independent of the widget size and of real time
+class TurntableRenderer {
+ public:
+  /// @brief Receives every rendered frame, returns false to abort rendering
+  using FrameSink = std::function<bool(const QImage& frame, int index)>;
+
+  static constexpr int DEFAULT_FRAMES = 36;
+  static constexpr int DEFAULT_SIZE = 1024;
+
+  TurntableRenderer(View* view, Controller* controller);
+  ~TurntableRenderer() = default;
+
+  bool render(int frames, const QSize& size, const FrameSink& sink);
+  bool renderToDirectory(const QString& dirPath, int frames = DEFAULT_FRAMES,
+                         const QSize& size = QSize(DEFAULT_SIZE,
+                                                   DEFAULT_SIZE));
+
+ private:
+  View* m_view;
+  Controller* m_controller;
+
+  static int frameAngle(int start, int index, int frames);
+};
+
+}  // namespace s21
+
+#endif  // TURNTABLE_RENDERER_H
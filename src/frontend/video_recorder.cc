@@ -0,0 +1,57 @@
+/**
+ @file video_recorder.cc
+ @brief This file contains the implementation of VideoRecorder functions
+ */
+
+#include "video_recorder.h"
+
+#include <QDebug>
+
+#include "frame_capture.h"
+
+/// @brief Constructs video recorder and connects frame capture signal
+/// @param targetWidget Widget to record
+/// @param fps Frame rate
+/// @param parent Parent QObject
+s21::VideoRecorder::VideoRecorder(QWidget* targetWidget, int fps,
+                                  QObject* parent)
+    : QObject(parent), m_widget(targetWidget), m_fps(fps), m_failed(false) {
+  connect(&m_timer, &QTimer::timeout, this, &VideoRecorder::captureFrame);
+}
+
+/// @brief Ensures recording stops and the file is finalized
+s21::VideoRecorder::~VideoRecorder() { stopRecording(); }
+
+/// @brief Opens the output file and starts capturing frames
+/// @param outputFilePath Destination file, the format is chosen by extension
+/// @return True if recording has started
+bool s21::VideoRecorder::startRecording(const QString& outputFilePath) {
+  if (isRecording() || !m_widget || m_fps < 1) return false;
+  m_writer = VideoWriter::create(outputFilePath);
+  if (!m_writer || !m_writer->open(outputFilePath, m_widget->size(), m_fps)) {
+    m_writer.reset();
+    return false;
+  }
+  m_failed = false;
+  m_timer.start(1000 / m_fps);
+  return true;
+}
+
+/// @brief Stops capturing and closes the output file
+void s21::VideoRecorder::stopRecording() {
+  if (!isRecording()) return;
+  m_timer.stop();
+  bool success = m_writer->close() && !m_failed;
+  m_writer.reset();
+  emit recordingStopped(success);
+}
+
+/// @brief Captures a frame and writes it to the output file
+void s21::VideoRecorder::captureFrame() {
+  if (!m_widget || !m_writer) return;
+  if (!m_writer->writeFrame(CaptureWidgetFrame(m_widget, m_widget->size()))) {
+    qCritical() << "Video recording error: failed to write frame";
+    m_failed = true;
+    stopRecording();
+  }
+}
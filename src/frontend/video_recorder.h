@@ -0,0 +1,48 @@
+/**
+ @file video_recorder.h
+ @brief This file contains VideoRecorder class declaration
+ */
+
+#ifndef VIDEO_RECORDER_H
+#define VIDEO_RECORDER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+#include <memory>
+
+#include "video_writer.h"
+
+namespace s21 {
+/// @class VideoRecorder
+/// @brief Records widget content to a Y4M or APNG file
+/// @details Every captured frame is written to the file at once, so a
+///          recording may last as long as needed
+class VideoRecorder : public QObject {
+  Q_OBJECT
+ public:
+  explicit VideoRecorder(QWidget* targetWidget, int fps = 25,
+                         QObject* parent = nullptr);
+  ~VideoRecorder();
+
+  bool startRecording(const QString& outputFilePath);
+  void stopRecording();
+  bool isRecording() const { return m_writer != nullptr; }
+
+ signals:
+  void recordingStopped(bool success);
+
+ private slots:
+  void captureFrame();
+
+ private:
+  QWidget* m_widget;
+  QTimer m_timer;
+  int m_fps;
+  bool m_failed;
+  std::unique_ptr<VideoWriter> m_writer;
+};
+}  // namespace s21
+
+#endif  // VIDEO_RECORDER_H
@@ -0,0 +1,154 @@
+/**
+ @file video_writer.cc
+ @brief This file contains the implementation of VideoWriter, Y4mWriter and
+ ApngWriter functions
+ */
+
+#include "video_writer.h"
+
+#include "yuv_convert.h"
+
+/// @brief Creates a writer matching the file extension
+/// @param path Destination file path, ".y4m" or ".png"/".apng"
+/// @return The writer or nullptr for an unsupported extension
+std::unique_ptr<s21::VideoWriter> s21::VideoWriter::create(
+    const QString& path) {
+  if (path.endsWith(".y4m", Qt::CaseInsensitive))
+    return std::make_unique<Y4mWriter>();
+  if (path.endsWith(".png", Qt::CaseInsensitive) ||
+      path.endsWith(".apng", Qt::CaseInsensitive))
+    return std::make_unique<ApngWriter>();
+  return nullptr;
+}
+
+/// @brief Opens a Y4M file and writes the stream header
+/// @param path Destination file path
+/// @param size Frame size, frames of another size are scaled
+/// @param fps Frame rate
+/// @return True on success
+bool s21::Y4mWriter::open(const QString& path, const QSize& size, int fps) {
+  if (m_file.isOpen() || size.isEmpty() || fps < 1) return false;
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+  m_size = size;
+  size_t luma = (size_t)size.width() * size.height();
+  size_t chroma =
+      (size_t)((size.width() + 1) / 2) * ((size.height() + 1) / 2);
+  m_planes.resize(luma + 2 * chroma);
+  QByteArray header = QString::asprintf("YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 "
+                                        "C420jpeg\n",
+                                        size.width(), size.height(), fps)
+                          .toLatin1();
+  return m_file.write(header) == header.size();
+}
+
+/// @brief Converts a frame to YUV 4:2:0 and appends it to the file
+/// @param frame Frame to be written
+/// @return True on success
+bool s21::Y4mWriter::writeFrame(const QImage& frame) {
+  if (!m_file.isOpen()) return false;
+  QImage image = frame.size() == m_size ? frame : frame.scaled(m_size);
+  if (image.format() != QImage::Format_RGB32 &&
+      image.format() != QImage::Format_ARGB32 &&
+      image.format() != QImage::Format_ARGB32_Premultiplied)
+    image = image.convertToFormat(QImage::Format_RGB32);
+
+  size_t luma = (size_t)m_size.width() * m_size.height();
+  size_t chroma = (m_planes.size() - luma) / 2;
+  ConvertArgbToYuv420(image.constBits(), m_size.width(), m_size.height(),
+                      image.bytesPerLine(), m_planes.data(),
+                      m_planes.data() + luma, m_planes.data() + luma + chroma);
+
+  if (m_file.write("FRAME\n", 6) != 6) return false;
+  return m_file.write((const char*)m_planes.data(), m_planes.size()) ==
+         (qint64)m_planes.size();
+}
+
+/// @brief Closes the file
+/// @return True if the file was opened
+bool s21::Y4mWriter::close() {
+  if (!m_file.isOpen()) return false;
+  m_file.close();
+  return true;
+}
+
+/// @brief Opens an APNG file and writes the header and a placeholder
+/// animation control chunk
+/// @param path Destination file path
+/// @param size Frame size, frames of another size are scaled
+/// @param fps Frame rate
+/// @return True on success
+bool s21::ApngWriter::open(const QString& path, const QSize& size, int fps) {
+  if (m_file.isOpen() || size.isEmpty() || fps < 1) return false;
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+  m_size = size;
+  m_fps = fps;
+  m_frames = 0;
+  m_sequence = 0;
+  m_stream = std::make_unique<PngStream>(&m_file);
+  if (!m_stream->writeSignature() ||
+      !m_stream->writeHeader(size.width(), size.height()))
+    return false;
+  m_actlPos = m_file.pos();
+  return m_stream->writeChunk("acTL", animationControl());
+}
+
+/// @brief Compresses a frame and appends it to the animation
+/// @details The first frame is stored as the default image (IDAT), the
+///          others as fdAT chunks
+/// @param frame Frame to be written
+/// @return True on success
+bool s21::ApngWriter::writeFrame(const QImage& frame) {
+  if (!m_file.isOpen() || !m_stream) return false;
+  QImage image = frame.size() == m_size ? frame : frame.scaled(m_size);
+  image = image.convertToFormat(QImage::Format_RGB888);
+
+  QByteArray control;
+  PngStream::putUint32(control, m_sequence++);
+  PngStream::putUint32(control, m_size.width());
+  PngStream::putUint32(control, m_size.height());
+  PngStream::putUint32(control, 0);  // x offset
+  PngStream::putUint32(control, 0);  // y offset
+  PngStream::putUint16(control, 1);  // delay numerator
+  PngStream::putUint16(control, m_fps);
+  control.append((char)0);  // dispose: none
+  control.append((char)0);  // blend: source
+  if (!m_stream->writeChunk("fcTL", control)) return false;
+
+  if (!m_stream->beginImage(m_frames == 0 ? nullptr : &m_sequence))
+    return false;
+  for (int row = 0; row < image.height(); ++row) {
+    if (!m_stream->writeRow(image.constScanLine(row))) return false;
+  }
+  if (!m_stream->endImage()) return false;
+  ++m_frames;
+  return true;
+}
+
+/// @brief Writes the final frame count and closes the file
+/// @details An animation without frames is not a valid PNG and is removed
+/// @return True if a valid file was written
+bool s21::ApngWriter::close() {
+  if (!m_file.isOpen()) return false;
+  bool result = m_frames > 0 && m_stream->writeEnd();
+  if (result) {
+    qint64 end = m_file.pos();
+    result = m_file.seek(m_actlPos) &&
+             m_stream->writeChunk("acTL", animationControl()) &&
+             m_file.seek(end);
+  }
+  m_stream.reset();
+  m_file.close();
+  if (!result) m_file.remove();
+  return result;
+}
+
+/// @brief Builds the acTL chunk payload
+/// @return Frame count and infinite loop flag
+QByteArray s21::ApngWriter::animationControl() const {
+  QByteArray data;
+  PngStream::putUint32(data, m_frames);
+  PngStream::putUint32(data, 0);  // loop forever
+  return data;
+}
@@ -0,0 +1,76 @@
+/**
+ @file video_writer.h
+ @brief This file contains VideoWriter, Y4mWriter and ApngWriter classes
+ declaration
+ */
+
+#ifndef VIDEO_WRITER_H
+#define VIDEO_WRITER_H
+
+#include <QFile>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "png_stream.h"
+
+namespace s21 {
+/// @class VideoWriter
+/// @brief Streams frames to a video file one by one, so memory use does not
+/// depend on the recording length
+class VideoWriter {
+ public:
+  virtual ~VideoWriter() = default;
+
+  virtual bool open(const QString& path, const QSize& size, int fps) = 0;
+  virtual bool writeFrame(const QImage& frame) = 0;
+  virtual bool close() = 0;
+
+  static std::unique_ptr<VideoWriter> create(const QString& path);
+};
+
+/// @class Y4mWriter
+/// @brief Writes raw YUV 4:2:0 frames in YUV4MPEG2 format
+class Y4mWriter : public VideoWriter {
+ public:
+  Y4mWriter() = default;
+  ~Y4mWriter() override { close(); }
+
+  bool open(const QString& path, const QSize& size, int fps) override;
+  bool writeFrame(const QImage& frame) override;
+  bool close() override;
+
+ private:
+  QFile m_file;
+  QSize m_size;
+  std::vector<uint8_t> m_planes;
+};
+
+/// @class ApngWriter
+/// @brief Writes lossless RGB frames as an animated PNG
+class ApngWriter : public VideoWriter {
+ public:
+  ApngWriter() = default;
+  ~ApngWriter() override { close(); }
+
+  bool open(const QString& path, const QSize& size, int fps) override;
+  bool writeFrame(const QImage& frame) override;
+  bool close() override;
+
+ private:
+  QFile m_file;
+  std::unique_ptr<PngStream> m_stream;
+  QSize m_size;
+  int m_fps = 0;
+  uint32_t m_frames = 0;
+  uint32_t m_sequence = 0;
+  qint64 m_actlPos = 0;
+
+  QByteArray animationControl() const;
+};
+}  // namespace s21
+
+#endif  // VIDEO_WRITER_H
@@ -0,0 +1,157 @@
+/**
+ @file yuv_convert.cc
+ @brief This file contains the implementation of RGB to YUV conversion
+ @details Pixels are stored as B, G, R, A bytes. Luma is counted as
+          (77R + 150G + 29B + 128) >> 8, chroma of every 2x2 block is counted
+          from the rounded average of its pixels. The SSE2 path gives exactly
+          the same result as the scalar one, which handles the image borders.
+ */
+
+#include "yuv_convert.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr int kBlue = 0;
+constexpr int kGreen = 1;
+constexpr int kRed = 2;
+
+inline uint8_t Average(uint8_t a, uint8_t b) { return (a + b + 1) >> 1; }
+
+inline uint8_t Clamp(int value) {
+  return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+inline uint8_t Luma(const uint8_t* px) {
+  return (77 * px[kRed] + 150 * px[kGreen] + 29 * px[kBlue] + 128) >> 8;
+}
+
+inline uint8_t ChromaU(const uint8_t* px) {
+  return Clamp(((-43 * px[kRed] - 85 * px[kGreen] + 128 * px[kBlue] + 128) >>
+                8) +
+               128);
+}
+
+inline uint8_t ChromaV(const uint8_t* px) {
+  return Clamp(((128 * px[kRed] - 107 * px[kGreen] - 21 * px[kBlue] + 128) >>
+                8) +
+               128);
+}
+
+/// @brief Averages a 2x2 block, missing border pixels repeat the last ones
+void BlockAverage(const uint8_t* row0, const uint8_t* row1, int x, int width,
+                  uint8_t* out) {
+  int x1 = x + 1 < width ? x + 1 : x;
+  for (int c = 0; c < 4; ++c) {
+    uint8_t left = Average(row0[x * 4 + c], row1[x * 4 + c]);
+    uint8_t right = Average(row0[x1 * 4 + c], row1[x1 * 4 + c]);
+    out[c] = Average(left, right);
+  }
+}
+
+#ifdef __SSE2__
+/// @brief Sums the madd results of two pixels and returns them in the low half
+inline __m128i PairSums(__m128i madd) {
+  __m128i sums = _mm_add_epi32(madd, _mm_srli_epi64(madd, 32));
+  return _mm_shuffle_epi32(sums, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/// @brief Applies coefficients to 4 BGRA pixels and returns 4 int32 results
+inline __m128i Weights4(__m128i pixels, __m128i coeffs) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i lo =
+      PairSums(_mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), coeffs));
+  __m128i hi =
+      PairSums(_mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), coeffs));
+  __m128i sums = _mm_unpacklo_epi64(lo, hi);
+  return _mm_srai_epi32(_mm_add_epi32(sums, _mm_set1_epi32(128)), 8);
+}
+
+/// @brief Converts 8 pixels of a row to luma
+inline void Luma8(const uint8_t* src, uint8_t* dst) {
+  const __m128i coeffs = _mm_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0);
+  __m128i a = Weights4(_mm_loadu_si128((const __m128i*)src), coeffs);
+  __m128i b = Weights4(_mm_loadu_si128((const __m128i*)(src + 16)), coeffs);
+  __m128i packed = _mm_packs_epi32(a, b);
+  _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(packed, packed));
+}
+
+/// @brief Averages 8x2 pixels into 4 block pixels
+inline __m128i Blocks4(const uint8_t* row0, const uint8_t* row1) {
+  __m128i a = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)row0),
+                           _mm_loadu_si128((const __m128i*)row1));
+  __m128i b = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(row0 + 16)),
+                           _mm_loadu_si128((const __m128i*)(row1 + 16)));
+  __m128 fa = _mm_castsi128_ps(a);
+  __m128 fb = _mm_castsi128_ps(b);
+  __m128i even =
+      _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0)));
+  __m128i odd =
+      _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1)));
+  return _mm_avg_epu8(even, odd);
+}
+
+/// @brief Converts 4 block pixels to 4 chroma values
+inline void Chroma4(__m128i blocks, __m128i coeffs, uint8_t* dst) {
+  __m128i values = _mm_add_epi32(Weights4(blocks, coeffs), _mm_set1_epi32(128));
+  __m128i packed = _mm_packs_epi32(values, values);
+  packed = _mm_packus_epi16(packed, packed);
+  int word = _mm_cvtsi128_si32(packed);
+  dst[0] = word & 0xFF;
+  dst[1] = (word >> 8) & 0xFF;
+  dst[2] = (word >> 16) & 0xFF;
+  dst[3] = (word >> 24) & 0xFF;
+}
+#endif
+}  // namespace
+
+/// @brief Converts a 32-bit xRGB image (QImage::Format_RGB32/ARGB32 memory
+/// layout) to planar YUV 4:2:0 using full range BT.601 coefficients
+/// @param argb Pointer to the first pixel
+/// @param width Image width in pixels
+/// @param height Image height in pixels
+/// @param stride Distance between rows in bytes
+/// @param y Luma plane, width * height bytes
+/// @param u Cb plane, ((width + 1) / 2) * ((height + 1) / 2) bytes
+/// @param v Cr plane, same size as the Cb plane
+void s21::ConvertArgbToYuv420(const uint8_t* argb, int width, int height,
+                              size_t stride, uint8_t* y, uint8_t* u,
+                              uint8_t* v) {
+  int chroma_width = (width + 1) / 2;
+  for (int row = 0; row < height; row += 2) {
+    const uint8_t* row0 = argb + row * stride;
+    const uint8_t* row1 = row + 1 < height ? row0 + stride : row0;
+    uint8_t* y0 = y + row * width;
+    uint8_t* y1 = row + 1 < height ? y0 + width : nullptr;
+    uint8_t* u_row = u + (row / 2) * chroma_width;
+    uint8_t* v_row = v + (row / 2) * chroma_width;
+
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i u_coeffs = _mm_setr_epi16(128, -85, -43, 0, 128, -85, -43, 0);
+    const __m128i v_coeffs =
+        _mm_setr_epi16(-21, -107, 128, 0, -21, -107, 128, 0);
+    for (; x + 8 <= width; x += 8) {
+      Luma8(row0 + x * 4, y0 + x);
+      if (y1) Luma8(row1 + x * 4, y1 + x);
+      __m128i blocks = Blocks4(row0 + x * 4, row1 + x * 4);
+      Chroma4(blocks, u_coeffs, u_row + x / 2);
+      Chroma4(blocks, v_coeffs, v_row + x / 2);
+    }
+#endif
+    for (; x < width; x += 2) {
+      y0[x] = Luma(row0 + x * 4);
+      if (x + 1 < width) y0[x + 1] = Luma(row0 + (x + 1) * 4);
+      if (y1) {
+        y1[x] = Luma(row1 + x * 4);
+        if (x + 1 < width) y1[x + 1] = Luma(row1 + (x + 1) * 4);
+      }
+      uint8_t block[4];
+      BlockAverage(row0, row1, x, width, block);
+      u_row[x / 2] = ChromaU(block);
+      v_row[x / 2] = ChromaV(block);
+    }
+  }
+}
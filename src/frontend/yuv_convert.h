@@ -0,0 +1,17 @@
+/**
+ @file yuv_convert.h
+ @brief This file contains RGB to YUV conversion functions declaration
+ */
+
+#ifndef YUV_CONVERT_H
+#define YUV_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace s21 {
+void ConvertArgbToYuv420(const uint8_t* argb, int width, int height,
+                         size_t stride, uint8_t* y, uint8_t* u, uint8_t* v);
+}  // namespace s21
+
+#endif  // YUV_CONVERT_H
@@ -4,20 +4,75 @@
  */
 
 #include <QApplication>
+#include <QGuiApplication>
 
 #include "backend/backend.h"
 #include "backend/controller.h"
+#include "backend/model_cache.h"
+#include "frontend/batch_runner.h"
 #include "frontend/frontend.h"
+#include "frontend/prefetcher.h"
 
 int main(int argc, char* argv[]) {
+  if (s21::BatchRunner::isBatchMode(argc, argv)) {
+    // Servers usually have no display, render through an offscreen surface
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    s21::BatchRunner runner;
+    return runner.run(app.arguments());
+  }
+
   QApplication app(argc, argv);
 
+  // Recently opened models stay parsed, VIEWER_CACHE_MB overrides the budget
+  bool budgetSet = false;
+  int budget = qEnvironmentVariableIntValue("VIEWER_CACHE_MB", &budgetSet);
+  s21::ModelCache cache(budgetSet && budget >= 0
+                            ? (size_t)budget << 20
+                            : s21::ModelCache::DEFAULT_BUDGET);
+
   s21::Controller controller;
+  controller.SetCache(&cache);
+
+  // Brick files keep only the bricks in view, VIEWER_BRICK_MB sets how much
+  // memory they may take
+  bool bricksSet = false;
+  int bricks = qEnvironmentVariableIntValue("VIEWER_BRICK_MB", &bricksSet);
+  if (bricksSet && bricks >= 0) controller.SetBrickBudget((size_t)bricks << 20);
+
+  // Models that would take more than VIEWER_MEMORY_MB are refused up front
+  bool limitSet = false;
+  int limit = qEnvironmentVariableIntValue("VIEWER_MEMORY_MB", &limitSet);
+  if (limitSet && limit > 0) controller.SetMemoryLimit((size_t)limit << 20);
+
+  // VIEWER_WELD merges vertices closer than the given distance, 0 merges
+  // equal ones only
+  bool weldSet = false;
+  double weld = qEnvironmentVariable("VIEWER_WELD").toDouble(&weldSet);
+  if (weldSet) controller.SetWelding(weld);
+
+  // VIEWER_COMPACT=1 keeps positions quantized to 16 bits, for huge models
+  controller.SetCompact(qEnvironmentVariableIntValue("VIEWER_COMPACT") != 0);
+
+  // VIEWER_REORDER=1 reorders faces and vertices for the vertex cache
+  controller.SetReordering(qEnvironmentVariableIntValue("VIEWER_REORDER") != 0);
 
   s21::View view(&controller);
   view.setWindowTitle("3d Viewer");
   view.setFixedSize(650, 650);
 
+  // Neighbouring files are parsed ahead, VIEWER_PREFETCH sets how many in
+  // each direction, 0 turns it off
+  bool distanceSet = false;
+  int distance = qEnvironmentVariableIntValue("VIEWER_PREFETCH", &distanceSet);
+  if (!distanceSet) distance = s21::Prefetcher::DEFAULT_DISTANCE;
+  s21::Prefetcher prefetcher(&controller, &cache);
+  prefetcher.setDistance(distance);
+  if (distance > 0)
+    QObject::connect(&view, &s21::View::modelOpened, &prefetcher,
+                     &s21::Prefetcher::prefetchNeighbours);
+
   view.show();
 
   return app.exec();
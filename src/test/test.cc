@@ -1,8 +1,19 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <random>
+#include <thread>
+
 #include "../backend/backend.h"
+#include "../backend/brick_file.h"
 #include "../backend/constants.h"
 #include "../backend/controller.h"
+#include "../backend/line_strips.h"
+#include "../backend/model_cache.h"
+#include "../backend/tail_reader.h"
+#include "../backend/triangulation.h"
+#include "../backend/vertex_cache.h"
+#include "../backend/viewer_core.h"
 
 GTEST_TEST(files, get_file) {
   s21::Controller controller;
@@ -61,6 +72,702 @@ GTEST_TEST(files, get_file) {
   }
 }
 
+GTEST_TEST(files, bounding_box) {
+  s21::Controller controller;
+
+  ASSERT_FALSE(controller.OpenFile("wrong_name.obj"));
+  ASSERT_TRUE(controller.OpenFile("test/test.obj"));
+
+  s21::bounding_box box = controller.GetBoundingBox();
+  ASSERT_FLOAT_EQ(box.min.x, -399.307190);
+  ASSERT_FLOAT_EQ(box.min.y, -399.307190);
+  ASSERT_FLOAT_EQ(box.min.z, -399.307190);
+  ASSERT_FLOAT_EQ(box.max.x, 399.307190);
+  ASSERT_FLOAT_EQ(box.max.y, 399.307190);
+  ASSERT_FLOAT_EQ(box.max.z, 399.307190);
+}
+
+GTEST_TEST(files, parallel_load) {
+  std::vector<size_t> points(8), polygons(8);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < points.size(); ++i) {
+    threads.emplace_back([i, &points, &polygons]() {
+      s21::Controller controller(false);
+      controller.OpenFile("test/test.obj");
+      points[i] = controller.GetPoints()->size();
+      polygons[i] = controller.GetPolygons()->size();
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  for (size_t i = 0; i < points.size(); ++i) {
+    ASSERT_EQ(points[i], 8);
+    ASSERT_EQ(polygons[i], 6);
+  }
+}
+
+GTEST_TEST(core, load_obj) {
+  s21::mesh_buffers mesh;
+
+  ASSERT_FALSE(s21::LoadObj("wrong_name.obj", &mesh));
+  ASSERT_TRUE(s21::LoadObj("test/test.obj", &mesh));
+
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+
+  ASSERT_EQ(mesh.positions.size(), 24);
+  ASSERT_EQ(mesh.face_offsets.size(), 7);
+  ASSERT_EQ(mesh.face_offsets.back(), mesh.indices.size());
+  for (size_t i = 0; i < 8; ++i) {
+    s21::vertice expected = controller.GetPoints()->at(i);
+    ASSERT_DOUBLE_EQ(mesh.positions[i * 3], expected.x);
+    ASSERT_DOUBLE_EQ(mesh.positions[i * 3 + 1], expected.y);
+    ASSERT_DOUBLE_EQ(mesh.positions[i * 3 + 2], expected.z);
+  }
+  for (size_t face = 0; face < 6; ++face) {
+    s21::FaceView loop = controller.GetPolygons()->at(face);
+    ASSERT_EQ(mesh.face_offsets[face + 1] - mesh.face_offsets[face],
+              loop.size());
+    for (size_t i = 0; i < loop.size(); ++i)
+      ASSERT_EQ(mesh.indices[mesh.face_offsets[face] + i], loop[i]);
+  }
+}
+
+GTEST_TEST(core, load_from_memory) {
+  const char data[] =
+      "v 0 0 0\nv 2 0 0\nv 2 4 0\nv 0 4 6\nf 1 2 3\nf 1 3 4\n";
+  s21::mesh_buffers mesh;
+
+  ASSERT_TRUE(s21::LoadObjFromMemory(data, sizeof(data) - 1, &mesh));
+  ASSERT_EQ(mesh.positions.size(), 12);
+  ASSERT_EQ(mesh.indices, std::vector<int64_t>({0, 1, 2, 0, 2, 3}));
+  ASSERT_DOUBLE_EQ(mesh.source_bounds.max.y, 4);
+  ASSERT_DOUBLE_EQ(mesh.source_bounds.max.z, 6);
+
+  ASSERT_TRUE(s21::LoadObjFromMemory(data, 0, &mesh));
+  ASSERT_EQ(mesh.positions.size(), 0);
+  ASSERT_EQ(mesh.face_offsets.size(), 1);
+
+  // A model over the memory limit is refused, not returned empty
+  ASSERT_TRUE(s21::LoadObjFromMemory(data, sizeof(data) - 1, &mesh));
+  ASSERT_FALSE(s21::LoadObjFromMemory(data, sizeof(data) - 1, &mesh, 64));
+  ASSERT_EQ(mesh.positions.size(), 12);
+}
+
+GTEST_TEST(core, transform) {
+  s21::mesh_buffers mesh;
+  s21::LoadObj("test/test.obj", &mesh);
+
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  controller.ZoomValue(25);
+  controller.RotateX(30);
+  controller.RotateY(-45);
+  controller.RotateZ(60);
+  controller.ShiftXValue(10);
+  controller.ShiftZValue(-5);
+
+  double matrix[16];
+  s21::MakeTransform(controller.GetZoom() / 25, controller.GetRotation(),
+                     controller.GetShift(), matrix);
+  s21::TransformMesh(&mesh, matrix);
+
+  for (size_t i = 0; i < 8; ++i) {
+    s21::vertice expected = controller.GetPoints()->at(i);
+    ASSERT_NEAR(mesh.positions[i * 3], expected.x, 1e-6);
+    ASSERT_NEAR(mesh.positions[i * 3 + 1], expected.y, 1e-6);
+    ASSERT_NEAR(mesh.positions[i * 3 + 2], expected.z, 1e-6);
+  }
+}
+
+GTEST_TEST(core, export_obj) {
+  s21::mesh_buffers mesh, copy;
+  s21::LoadObj("test/test.obj", &mesh);
+
+  std::string text;
+  s21::ExportObj(mesh, &text);
+  ASSERT_TRUE(s21::LoadObjFromMemory(text.data(), text.size(), &copy));
+
+  ASSERT_EQ(copy.positions, mesh.positions);
+  ASSERT_EQ(copy.indices, mesh.indices);
+  ASSERT_EQ(copy.face_offsets, mesh.face_offsets);
+}
+
+GTEST_TEST(core, parallel_load) {
+  std::vector<s21::mesh_buffers> meshes(8);
+  std::vector<std::thread> threads;
+
+  for (s21::mesh_buffers& mesh : meshes)
+    threads.emplace_back([&mesh]() { s21::LoadObj("test/test.obj", &mesh); });
+  for (std::thread& thread : threads) thread.join();
+
+  for (const s21::mesh_buffers& mesh : meshes) {
+    ASSERT_EQ(mesh.positions, meshes[0].positions);
+    ASSERT_EQ(mesh.indices, meshes[0].indices);
+  }
+}
+
+GTEST_TEST(snapshot, versions) {
+  s21::Controller controller(false);
+  s21::geometry_snapshot empty = controller.GetSnapshot();
+  ASSERT_EQ(empty->points.size(), 0);
+  ASSERT_EQ(empty->polygons->size(), 0);
+
+  controller.OpenFile("test/test.obj");
+  s21::geometry_snapshot loaded = controller.GetSnapshot();
+  ASSERT_EQ(empty->points.size(), 0);
+  ASSERT_EQ(loaded->points.size(), 8);
+  ASSERT_EQ(loaded->polygons->size(), 6);
+
+  s21::SharedArray<s21::vertice> points = loaded->points;
+  controller.ZoomValue(25);
+  s21::geometry_snapshot zoomed = controller.GetSnapshot();
+
+  ASSERT_NE(zoomed, loaded);
+  ASSERT_EQ(zoomed->polygons, loaded->polygons);
+  for (size_t i = 0; i < points.size(); ++i) {
+    ASSERT_DOUBLE_EQ(loaded->points[i].x, points[i].x);
+    ASSERT_DOUBLE_EQ(zoomed->points[i].x, points[i].x * 2);
+    ASSERT_DOUBLE_EQ(zoomed->points[i].y, controller.GetPoints()->at(i).y);
+  }
+}
+
+GTEST_TEST(snapshot, concurrent_readers) {
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  std::atomic<bool> done = false;
+  std::vector<std::thread> readers;
+  // One element per reader, vector<bool> would share bits between them
+  std::vector<char> valid(4, true);
+
+  for (size_t i = 0; i < valid.size(); ++i) {
+    readers.emplace_back([i, &controller, &done, &valid]() {
+      while (!done) {
+        s21::geometry_snapshot current = controller.GetSnapshot();
+        // Reloading withdraws the published version first, readers may see
+        // the empty one published in its place
+        bool empty = current->points.empty() && current->polygons->empty();
+        if (!empty &&
+            (current->points.size() != 8 || current->polygons->size() != 6))
+          valid[i] = false;
+        for (s21::FaceView loop : *current->polygons)
+          for (int index : loop)
+            if ((size_t)index >= current->points.size()) valid[i] = false;
+      }
+    });
+  }
+  for (int step = 0; step < 200; ++step) {
+    controller.RotateX(step % 2 ? 5 : -5);
+    controller.ShiftYValue(step % 2 ? 0.1 : -0.1);
+    if (step % 50 == 0) controller.OpenFile("test/test.obj");
+  }
+  done = true;
+  for (std::thread& reader : readers) reader.join();
+
+  for (char result : valid) ASSERT_TRUE(result);
+}
+
+GTEST_TEST(cache, reopen) {
+  s21::ModelCache cache;
+  s21::Controller controller(false);
+  controller.SetCache(&cache);
+
+  ASSERT_FALSE(controller.OpenFile("wrong_name.obj"));
+  ASSERT_TRUE(controller.OpenFile("test/test.obj"));
+  s21::geometry_snapshot first = controller.GetSnapshot();
+  std::vector<s21::vertice> points = *controller.GetPoints();
+  controller.RotateX(45);
+  controller.ZoomValue(10);
+
+  ASSERT_TRUE(controller.OpenFile("test/test.obj"));
+  s21::cache_stats stats = cache.GetStats();
+  ASSERT_EQ(stats.hits, 1);
+  ASSERT_EQ(stats.misses, 1);
+  ASSERT_EQ(stats.entries, 1);
+  ASSERT_EQ(stats.bytes, s21::ModelCache::CountBytes(*first));
+  ASSERT_EQ(controller.GetSnapshot(), first);
+  ASSERT_EQ(controller.GetRotation().x, 0);
+  ASSERT_EQ(controller.GetBoundingBox().max.x, 399.307190);
+  for (size_t i = 0; i < points.size(); ++i) {
+    ASSERT_DOUBLE_EQ(controller.GetPoints()->at(i).x, points[i].x);
+    ASSERT_DOUBLE_EQ(first->points[i].z, points[i].z);
+  }
+}
+
+GTEST_TEST(cache, modified_file) {
+  const char* path = "test/cache_modified.obj";
+  FILE* f = fopen(path, "w");
+  fputs("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", f);
+  fclose(f);
+
+  s21::ModelCache cache;
+  s21::Controller controller(false);
+  controller.SetCache(&cache);
+  controller.OpenFile(path);
+
+  f = fopen(path, "a");
+  fputs("v 0 0 1\nf 1 2 4\n", f);
+  fclose(f);
+  controller.OpenFile(path);
+  remove(path);
+
+  ASSERT_EQ(cache.GetStats().hits, 0);
+  ASSERT_EQ(cache.GetStats().misses, 2);
+  ASSERT_EQ(cache.GetStats().entries, 1);
+  ASSERT_EQ(controller.GetPoints()->size(), 4);
+  ASSERT_EQ(controller.GetPolygons()->size(), 2);
+}
+
+GTEST_TEST(cache, same_second) {
+  s21::ModelCache cache;
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  s21::cached_model model = {controller.GetSnapshot(),
+                             controller.GetBoundingBox(),
+                             controller.GetParsePosition()};
+  s21::file_stamp stamp;
+  ASSERT_TRUE(s21::ModelCache::Stamp("test/test.obj", &stamp));
+  ASSERT_TRUE(cache.Insert("test/test.obj", stamp, model));
+  ASSERT_TRUE(cache.Contains("test/test.obj", stamp));
+
+  // Rewritten within the same second with the same size
+  s21::file_stamp rewritten = stamp;
+  rewritten.mtime_nsec = (stamp.mtime_nsec + 1) % 1000000000;
+  ASSERT_FALSE(cache.Contains("test/test.obj", rewritten));
+  ASSERT_FALSE(cache.Find("test/test.obj", rewritten, &model));
+  ASSERT_EQ(cache.GetStats().entries, 0);
+}
+
+GTEST_TEST(cache, eviction) {
+  const char* paths[] = {"test/cache_a.obj", "test/cache_b.obj",
+                         "test/cache_c.obj"};
+  for (const char* path : paths) {
+    FILE* f = fopen(path, "w");
+    fputs("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", f);
+    fclose(f);
+  }
+
+  s21::ModelCache cache;
+  s21::Controller controller(false);
+  controller.SetCache(&cache);
+  controller.OpenFile(paths[0]);
+  size_t bytes = cache.GetStats().bytes;
+  cache.SetBudget(bytes * 2);
+
+  controller.OpenFile(paths[1]);
+  controller.OpenFile(paths[0]);
+  controller.OpenFile(paths[2]);
+  s21::cache_stats stats = cache.GetStats();
+  ASSERT_EQ(stats.entries, 2);
+  ASSERT_EQ(stats.evictions, 1);
+  ASSERT_EQ(stats.bytes, bytes * 2);
+
+  controller.OpenFile(paths[0]);
+  controller.OpenFile(paths[1]);
+  for (const char* path : paths) remove(path);
+
+  stats = cache.GetStats();
+  ASSERT_EQ(stats.hits, 2);
+  ASSERT_EQ(stats.misses, 4);
+  ASSERT_EQ(stats.evictions, 2);
+
+  cache.SetBudget(0);
+  ASSERT_EQ(cache.GetStats().entries, 0);
+  ASSERT_EQ(cache.GetStats().bytes, 0);
+}
+
+GTEST_TEST(cache, load_settings) {
+  s21::ModelCache cache;
+  s21::Controller compact(false);
+  compact.SetCache(&cache);
+  compact.SetCompact(true);
+  std::unique_ptr<s21::Controller> loader = compact.CreateLoader();
+  loader->SetCache(&cache);
+  std::thread worker([&loader]() { loader->Prefetch("test/test.obj"); });
+  worker.join();
+  ASSERT_TRUE(compact.OpenFile("test/test.obj"));
+  ASSERT_EQ(cache.GetStats().hits, 1);
+  ASSERT_NE(compact.GetSnapshot()->packed, nullptr);
+
+  // Models loaded another way are not taken from the cache
+  s21::Controller plain(false);
+  plain.SetCache(&cache);
+  ASSERT_TRUE(plain.OpenFile("test/test.obj"));
+  ASSERT_EQ(cache.GetStats().hits, 1);
+  ASSERT_EQ(plain.GetSnapshot()->packed, nullptr);
+  ASSERT_EQ(cache.GetStats().entries, 2);
+
+  // Cached models still have to fit the memory limit
+  s21::Controller limited(false);
+  limited.SetCache(&cache);
+  limited.SetMemoryLimit(1);
+  ASSERT_FALSE(limited.OpenFile("test/test.obj"));
+  ASSERT_TRUE(limited.GetLoadStats().refused);
+}
+
+GTEST_TEST(cache, prefetch) {
+  const char* paths[] = {"test/prefetch_a.obj", "test/prefetch_b.obj"};
+  for (const char* path : paths) {
+    FILE* f = fopen(path, "w");
+    fputs("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", f);
+    fclose(f);
+  }
+
+  s21::ModelCache cache;
+  std::thread worker([&cache, &paths]() {
+    s21::Controller controller(false);
+    controller.SetCache(&cache);
+    controller.Prefetch(paths[0]);
+  });
+  worker.join();
+
+  s21::cache_stats stats = cache.GetStats();
+  ASSERT_EQ(stats.prefetched, 1);
+  ASSERT_EQ(stats.hits + stats.misses, 0);
+
+  s21::Controller controller(false);
+  controller.SetCache(&cache);
+  ASSERT_TRUE(controller.Prefetch(paths[0]));
+  ASSERT_TRUE(controller.OpenFile(paths[0]));
+  ASSERT_EQ(cache.GetStats().hits, 1);
+  ASSERT_EQ(controller.GetPoints()->size(), 3);
+
+  cache.SetBudget(cache.GetStats().bytes);
+  ASSERT_FALSE(controller.Prefetch(paths[1]));
+
+  // The budget is checked against the estimate, not the file size, and a
+  // file that doesn't fit isn't parsed at all
+  s21::ModelCache small;
+  small.SetBudget(64);
+  s21::Controller skipped(false);
+  skipped.SetCache(&small);
+  ASSERT_FALSE(skipped.Prefetch(paths[1]));
+  ASSERT_EQ(skipped.GetPoints()->size(), 0);
+  ASSERT_FALSE(controller.Prefetch("wrong_name.obj"));
+  for (const char* path : paths) remove(path);
+
+  stats = cache.GetStats();
+  ASSERT_EQ(stats.prefetched, 1);
+  ASSERT_EQ(stats.entries, 1);
+  ASSERT_EQ(stats.evictions, 0);
+}
+
+GTEST_TEST(reload, append_tail) {
+  const char* path = "test/reload_append.obj";
+  FILE* f = fopen(path, "w");
+  fputs("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", f);
+  fclose(f);
+
+  s21::Controller controller(false);
+  controller.OpenFile(path);
+  controller.ZoomValue(10);
+  controller.RotateX(30);
+  controller.ShiftYValue(0.25);
+  controller.RotateY(-60);
+  controller.ShiftXValue(-0.5);
+  s21::parse_position from = controller.GetParsePosition();
+
+  f = fopen(path, "a");
+  fputs("v 4 -2 3\nv 1 1 1\nf 2 4 5\nv 7", f);
+  fclose(f);
+  s21::obj_tail tail;
+  ASSERT_TRUE(s21::Controller::ReadTail(path, from, &tail));
+  ASSERT_EQ(tail.points.size(), 2);
+  ASSERT_EQ(tail.polygons.size(), 1);
+  ASSERT_TRUE(controller.AppendTail(tail));
+
+  s21::Controller expected(false);
+  expected.OpenFile(path);
+  expected.ZoomValue(10);
+  expected.RotateX(30);
+  expected.ShiftYValue(0.25);
+  expected.RotateY(-60);
+  expected.ShiftXValue(-0.5);
+
+  ASSERT_EQ(controller.GetPoints()->size(), 5);
+  ASSERT_EQ(controller.GetPolygons()->size(), 2);
+  ASSERT_EQ(controller.GetParsePosition().offset,
+            expected.GetParsePosition().offset);
+  ASSERT_EQ(controller.GetBoundingBox().max.x, 4);
+  for (size_t i = 0; i < 5; ++i) {
+    s21::vertice current = controller.GetPoints()->at(i);
+    s21::vertice reference = expected.GetPoints()->at(i);
+    ASSERT_NEAR(current.x, reference.x, 1e-9);
+    ASSERT_NEAR(current.y, reference.y, 1e-9);
+    ASSERT_NEAR(current.z, reference.z, 1e-9);
+  }
+
+  f = fopen(path, "a");
+  fputs(" 8 9\n", f);
+  fclose(f);
+  ASSERT_TRUE(s21::Controller::ReadTail(
+      path, controller.GetParsePosition(), &tail));
+  ASSERT_EQ(tail.points.size(), 1);
+  ASSERT_EQ(tail.points[0].x, 7);
+  ASSERT_EQ(tail.points[0].z, 9);
+
+  f = fopen(path, "w");
+  fputs("v 5 5 5\nv 1 0 0\nv 0 1 0\nf 1 2 3\nv 4 -2 3\n", f);
+  fclose(f);
+  ASSERT_FALSE(s21::Controller::ReadTail(path, from, &tail));
+  remove(path);
+}
+
+GTEST_TEST(reload, follow) {
+  const char* path = "test/reload_follow.obj";
+  FILE* out = fopen(path, "w");
+  fputs("v 0 0 0\nv 1 1 1\n", out);
+  fflush(out);
+
+  s21::Controller controller(false);
+  controller.OpenFile(path);
+  s21::TailReader reader;
+  ASSERT_TRUE(reader.Open(path));
+
+  int reads = 0;
+  for (int i = 2; i < 200; ++i) {
+    fprintf(out, "v %d %d %d\n", i, i % 7, -i / 3);
+    if (i % 2) fprintf(out, "f %d %d %d\n", i - 1, i, i + 1);
+    if (i % 25 == 0) {
+      fflush(out);
+      s21::obj_tail tail;
+      do {
+        ASSERT_TRUE(reader.Read(controller.GetParsePosition(), &tail, 64));
+        ASSERT_TRUE(controller.AppendTail(tail, 2));
+        ++reads;
+      } while (!tail.points.empty() || !tail.polygons.empty());
+    }
+  }
+  fclose(out);
+  s21::obj_tail tail;
+  ASSERT_TRUE(reader.Read(controller.GetParsePosition(), &tail));
+  controller.AppendTail(tail, 2);
+  reader.Close();
+
+  s21::Controller expected(false);
+  expected.OpenFile(path);
+  remove(path);
+
+  ASSERT_GT(reads, 16);
+  ASSERT_EQ(controller.GetPoints()->size(), 200);
+  ASSERT_EQ(*controller.GetPolygons(), *expected.GetPolygons());
+  ASSERT_EQ(controller.GetBoundingBox().max.x, 199);
+  ASSERT_EQ(controller.GetBoundingBox().min.z, -66);
+
+  // Both are the same model up to scale and position
+  std::vector<s21::vertice> current = *controller.GetPoints();
+  std::vector<s21::vertice> reference = *expected.GetPoints();
+  double scale = (current[199].x - current[0].x) /
+                 (reference[199].x - reference[0].x);
+  for (size_t i = 0; i < current.size(); ++i) {
+    ASSERT_LE(fabs(current[i].x), 1);
+    ASSERT_NEAR(current[i].x - current[0].x,
+                (reference[i].x - reference[0].x) * scale, 1e-9);
+    ASSERT_NEAR(current[i].y - current[0].y,
+                (reference[i].y - reference[0].y) * scale, 1e-9);
+    ASSERT_NEAR(current[i].z - current[0].z,
+                (reference[i].z - reference[0].z) * scale, 1e-9);
+  }
+}
+
+/// @brief Checks that buffers built for appended faces match the ones a
+/// full load builds
+/// @param current Geometry the faces were appended to
+/// @param expected Geometry of the whole file
+static void ExpectSameBuffers(const s21::geometry& current,
+                              const s21::geometry& expected) {
+  ASSERT_EQ(current.line_strips->width, expected.line_strips->width);
+  ASSERT_EQ(current.line_strips->count, expected.line_strips->count);
+  ASSERT_EQ(current.line_strips->indices, expected.line_strips->indices);
+  ASSERT_EQ(current.triangles->indices.count,
+            expected.triangles->indices.count);
+  ASSERT_EQ(current.triangles->indices.indices,
+            expected.triangles->indices.indices);
+  ASSERT_EQ(current.triangles->faces, expected.triangles->faces);
+  ASSERT_EQ(current.triangles->edges, expected.triangles->edges);
+  const s21::normal_list& normals = *current.normals;
+  const s21::normal_list& reference = *expected.normals;
+  ASSERT_EQ(normals.faces.size(), reference.faces.size());
+  ASSERT_EQ(normals.vertices.size(), reference.vertices.size());
+  for (size_t i = 0; i < normals.faces.size(); ++i) {
+    ASSERT_NEAR(normals.faces[i].x, reference.faces[i].x, 1e-9);
+    ASSERT_NEAR(normals.faces[i].y, reference.faces[i].y, 1e-9);
+    ASSERT_NEAR(normals.faces[i].z, reference.faces[i].z, 1e-9);
+  }
+  for (size_t i = 0; i < normals.vertices.size(); ++i) {
+    ASSERT_NEAR(normals.vertices[i].x, reference.vertices[i].x, 1e-9);
+    ASSERT_NEAR(normals.vertices[i].y, reference.vertices[i].y, 1e-9);
+    ASSERT_NEAR(normals.vertices[i].z, reference.vertices[i].z, 1e-9);
+  }
+}
+
+GTEST_TEST(reload, append_buffers) {
+  const char* path = "test/reload_buffers.obj";
+  FILE* f = fopen(path, "w");
+  fputs("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n", f);
+  fclose(f);
+  s21::Controller controller(false);
+  controller.OpenFile(path);
+  controller.RotateX(30);
+  s21::geometry_snapshot before = controller.GetSnapshot();
+
+  // The new faces share vertices 2 and 3 with the old one, the last one
+  // uses vertex 7, which comes later
+  f = fopen(path, "a");
+  fputs("v 2 0 1\nv 2 1 1\nf 2 5 6 3\nf 6 5 7\n", f);
+  fclose(f);
+  s21::obj_tail tail;
+  ASSERT_TRUE(
+      s21::Controller::ReadTail(path, controller.GetParsePosition(), &tail));
+  ASSERT_TRUE(controller.AppendTail(tail, 2));
+  s21::geometry_snapshot after = controller.GetSnapshot();
+
+  s21::Controller expected(false);
+  expected.OpenFile(path);
+  ExpectSameBuffers(*after, *expected.GetSnapshot());
+  // Only the new faces were built, the old ones were copied
+  ASSERT_EQ(after->triangles->faces.size(), 4);
+  ASSERT_EQ(after->triangles->indices.indices[0],
+            before->triangles->indices.indices[0]);
+  ASSERT_EQ(after->normals->faces[0].y, before->normals->faces[0].y);
+  ASSERT_EQ(after->normals->vertices[0].z, before->normals->vertices[0].z);
+  ASSERT_NE(after->normals->vertices[1].x, before->normals->vertices[1].x);
+
+  // Vertex 7 makes the face read before complete, so everything is built
+  // again, then the sums go on from the new view
+  controller.RotateY(45);
+  f = fopen(path, "a");
+  fputs("v 3 0 0\nv 3 1 0\nf 5 7 8 6\nf 7 5 2\n", f);
+  fclose(f);
+  ASSERT_TRUE(
+      s21::Controller::ReadTail(path, controller.GetParsePosition(), &tail));
+  ASSERT_TRUE(controller.AppendTail(tail, 2));
+
+  // A far vertex refits the points, the kept sums are scaled with them
+  for (const char* records : {"f 1 4 8\n", "v 9 0 2\nf 8 7 9\n"}) {
+    f = fopen(path, "a");
+    fputs(records, f);
+    fclose(f);
+    ASSERT_TRUE(
+        s21::Controller::ReadTail(path, controller.GetParsePosition(), &tail));
+    ASSERT_TRUE(controller.AppendTail(tail, 2));
+  }
+  expected.OpenFile(path);
+  remove(path);
+  ExpectSameBuffers(*controller.GetSnapshot(), *expected.GetSnapshot());
+}
+
+GTEST_TEST(reload, share_storage) {
+  const char* path = "test/reload_share.obj";
+  FILE* f = fopen(path, "w");
+  fputs("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\nf 1 3 4\n", f);
+  fclose(f);
+  s21::Controller controller(false);
+  controller.OpenFile(path);
+
+  // The first tail moves the arrays into blocks with room for more, the
+  // second one is written into that room, past what the first version sees
+  s21::geometry_snapshot versions[2];
+  for (s21::geometry_snapshot& version : versions) {
+    f = fopen(path, "a");
+    fputs("v 0.5 0.5 0\nv 0.5 0 0\nf 1 2 3\n", f);
+    fclose(f);
+    s21::obj_tail tail;
+    ASSERT_TRUE(
+        s21::Controller::ReadTail(path, controller.GetParsePosition(), &tail));
+    ASSERT_TRUE(controller.AppendTail(tail, 2));
+    version = controller.GetSnapshot();
+  }
+  remove(path);
+  const s21::geometry& first = *versions[0];
+  const s21::geometry& second = *versions[1];
+  ASSERT_EQ(first.points.size(), 6);
+  ASSERT_EQ(second.points.size(), 8);
+  ASSERT_EQ(second.points.data(), first.points.data());
+  ASSERT_EQ(second.points.GetVersion(), first.points.GetVersion());
+  ASSERT_EQ(second.polygons->GetStarts().data(),
+            first.polygons->GetStarts().data());
+  ASSERT_EQ(second.triangles->faces.data(), first.triangles->faces.data());
+  ASSERT_EQ(second.triangles->edges.GetVersion(),
+            first.triangles->edges.GetVersion());
+  ASSERT_EQ(second.line_strips->indices.data(),
+            first.line_strips->indices.data());
+  ASSERT_EQ(second.normals->faces.data(), first.normals->faces.data());
+
+  // Changing a shared array copies it, the other version keeps its data
+  s21::SharedArray<s21::vertice> changed = second.points;
+  changed.MutableData()[0].x = 7;
+  ASSERT_NE(changed.data(), second.points.data());
+  ASSERT_NE(changed.GetVersion(), second.points.GetVersion());
+  ASSERT_EQ(first.points[0].x, second.points[0].x);
+  ASSERT_NE(second.points[0].x, 7);
+
+  // A copy that didn't end where the block was last written to can't
+  // extend it in place
+  s21::SharedArray<s21::vertice> older = first.points;
+  ASSERT_FALSE(older.Fits(1));
+  older.push_back({7, 7, 7});
+  ASSERT_NE(older.data(), first.points.data());
+  ASSERT_EQ(second.points[6].x, first.points.data()[6].x);
+}
+
+GTEST_TEST(reload, keep_view) {
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  controller.ZoomValue(-5);
+  controller.RotateZ(90);
+  controller.ShiftZValue(0.5);
+
+  s21::Controller loaded(false);
+  loaded.OpenFile("test/test.obj");
+  controller.ReloadFrom(&loaded);
+
+  s21::Controller expected(false);
+  expected.OpenFile("test/test.obj");
+  expected.ZoomValue(-5);
+  expected.RotateZ(90);
+  expected.ShiftZValue(0.5);
+
+  ASSERT_EQ(controller.GetZoom(), 20);
+  ASSERT_EQ(controller.GetRotation().z, 90);
+  ASSERT_EQ(controller.GetShift().z, 0.5);
+  ASSERT_EQ(controller.GetParsePosition().offset,
+            loaded.GetParsePosition().offset);
+  for (size_t i = 0; i < 8; ++i) {
+    ASSERT_NEAR(controller.GetPoints()->at(i).x,
+                expected.GetPoints()->at(i).x, 1e-9);
+    ASSERT_NEAR(controller.GetPoints()->at(i).z,
+                expected.GetPoints()->at(i).z, 1e-9);
+  }
+}
+
+GTEST_TEST(reload, keep_turned_view) {
+  // Rotations don't commute and the shift comes before them, so the view
+  // can't be rebuilt from per-axis totals
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  controller.ShiftXValue(0.5);
+  controller.RotateY(90);
+  controller.RotateX(30);
+  std::vector<s21::vertice> expected = *controller.GetPoints();
+
+  s21::Controller loaded(false);
+  loaded.OpenFile("test/test.obj");
+  controller.ReloadFrom(&loaded);
+
+  ASSERT_EQ(controller.GetShift().x, 0.5);
+  ASSERT_NEAR(controller.GetRotation().y, 90, 1e-9);
+  ASSERT_NEAR(controller.GetRotation().x, 30, 1e-9);
+  const std::vector<s21::vertice>& points = *controller.GetPoints();
+  ASSERT_EQ(points.size(), expected.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    ASSERT_NEAR(points[i].x, expected[i].x, 1e-9);
+    ASSERT_NEAR(points[i].y, expected[i].y, 1e-9);
+    ASSERT_NEAR(points[i].z, expected[i].z, 1e-9);
+  }
+}
+
 GTEST_TEST(zoom, zoom_plus) {
   s21::Controller controller;
 
@@ -647,6 +1354,750 @@ GTEST_TEST(visibility, save_load_prefs) {
   controller.ChangeProjection();
 }
 
+GTEST_TEST(visibility, hidden_lines) {
+  s21::Controller controller(false);
+  ASSERT_EQ(controller.GetHiddenLines(), 0);
+  controller.ChangeHiddenLines();
+  ASSERT_EQ(controller.GetHiddenLines(), 1);
+  controller.ChangeHiddenLines();
+  ASSERT_EQ(controller.GetHiddenLines(), 0);
+}
+
+GTEST_TEST(arena, reuse) {
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  ASSERT_GT(controller.GetLoadStats().allocations, 0);
+
+  // Nobody holds the faces, so the next load reuses them with no allocations
+  controller.OpenFile("test/test.obj");
+  ASSERT_TRUE(controller.GetLoadStats().reused);
+  ASSERT_EQ(controller.GetLoadStats().allocations, 0);
+  ASSERT_EQ(controller.GetPolygons()->size(), 6);
+  ASSERT_EQ(controller.GetPolygons()->at(1).at(3), 7);
+
+  // A reader keeps its version, the load starts new storage
+  s21::geometry_snapshot held = controller.GetSnapshot();
+  controller.OpenFile("test/test.obj");
+  ASSERT_FALSE(controller.GetLoadStats().reused);
+  ASSERT_EQ(*held->polygons, *controller.GetPolygons());
+  ASSERT_NE(held->polygons.get(), controller.GetPolygons());
+}
+
+GTEST_TEST(arena, reuse_with_cache) {
+  const char* path = "test/arena_triangle.obj";
+  FILE* f = fopen(path, "w");
+  fputs("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", f);
+  fclose(f);
+  s21::ModelCache cache;
+  s21::Controller controller(false);
+  controller.SetCache(&cache);
+  controller.OpenFile("test/test.obj");
+  const s21::FaceList* cached = controller.GetPolygons();
+
+  // The cache shares the faces, so they are left to it
+  controller.OpenFile(path);
+  ASSERT_FALSE(controller.GetLoadStats().reused);
+  ASSERT_NE(controller.GetPolygons(), cached);
+  ASSERT_TRUE(controller.OpenFile("test/test.obj"));
+  ASSERT_EQ(controller.GetPolygons(), cached);
+  ASSERT_EQ(controller.GetPolygons()->size(), 6);
+
+  // Models the cache can't take are reused as without it
+  cache.SetBudget(0);
+  s21::Controller uncached(false);
+  uncached.SetCache(&cache);
+  uncached.OpenFile("test/test.obj");
+  uncached.OpenFile(path);
+  remove(path);
+  ASSERT_TRUE(uncached.GetLoadStats().reused);
+  ASSERT_EQ(uncached.GetLoadStats().allocations, 0);
+  ASSERT_EQ(uncached.GetPolygons()->size(), 1);
+}
+
+GTEST_TEST(arena, face_list) {
+  s21::FaceList faces;
+  faces.push_back({0, 1, 2});
+  faces.push_back({});
+  faces.push_back({2, 3});
+  ASSERT_EQ(faces.size(), 3);
+  ASSERT_EQ(faces[1].size(), 0);
+  ASSERT_EQ(faces.at(2).at(1), 3);
+  ASSERT_THROW(faces.at(3), std::out_of_range);
+  ASSERT_THROW(faces[0].at(3), std::out_of_range);
+
+  s21::FaceList more = faces;
+  more.Append(faces);
+  ASSERT_EQ(more.size(), 6);
+  ASSERT_EQ(more[3], faces[0]);
+  ASSERT_EQ(more.GetStarts().back(), 10);
+
+  size_t bytes = more.CountBytes();
+  more.clear();
+  ASSERT_TRUE(more.empty());
+  ASSERT_EQ(more.CountBytes(), bytes);
+  ASSERT_EQ(more.GetAllocations(), 0);
+}
+
+GTEST_TEST(arena, index_width) {
+  s21::FaceList faces;
+  faces.push_back({0, 1, 2});
+  ASSERT_EQ(faces.GetIndexWidth(), 2);
+  ASSERT_TRUE(faces.InRange(3));
+  ASSERT_FALSE(faces.InRange(2));
+
+  faces.AddIndex(-1);
+  faces.AddIndex(70000);
+  faces.CloseFace();
+  ASSERT_EQ(faces.GetIndexWidth(), 4);
+  ASSERT_EQ(faces.at(0).at(2), 2);
+  ASSERT_EQ(faces.at(1).at(0), -1);
+  ASSERT_EQ(faces.at(1).at(1), 70000);
+  ASSERT_FALSE(faces.InRange(70001));
+
+  faces.push_back({});
+  faces.AddIndex(5000000000LL);
+  faces.CloseFace();
+  ASSERT_EQ(faces.GetIndexWidth(), 8);
+  ASSERT_EQ(faces.at(3).at(0), 5000000000LL);
+  ASSERT_EQ(faces.at(1).at(0), -1);
+  ASSERT_EQ(faces.CountIndices(), 6);
+
+  faces.Remap({0, 2, 1});
+  ASSERT_EQ(faces.at(0), faces.at(0));
+  ASSERT_EQ(faces.at(0).at(1), 2);
+  ASSERT_EQ(faces.GetIndexWidth(), 8);
+
+  faces.clear();
+  faces.reserve(1, 3, 100000);
+  ASSERT_EQ(faces.GetIndexWidth(), 4);
+  faces.push_back({0, 1, 2});
+  s21::FaceList narrow;
+  narrow.push_back({0, 1, 2});
+  ASSERT_EQ(faces, narrow);
+
+  // The test cube fits 16-bit indices
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  ASSERT_EQ(controller.GetPolygons()->GetIndexWidth(), 2);
+  ASSERT_EQ(controller.GetPolygons()->at(1).at(3), 7);
+}
+
+
+GTEST_TEST(arena, wide_iteration) {
+  // Indices past INT32_MAX come back whole, so loops over faces must take
+  // them as int64_t
+  s21::FaceList faces;
+  faces.AddIndex(1);
+  faces.AddIndex((int64_t)INT32_MAX + 5);
+  faces.AddIndex(2);
+  faces.CloseFace();
+  std::vector<int64_t> indices;
+  for (int64_t index : faces[0]) indices.push_back(index);
+  ASSERT_EQ(indices, std::vector<int64_t>({1, (int64_t)INT32_MAX + 5, 2}));
+  ASSERT_FALSE(faces.InRange((size_t)INT32_MAX + 5));
+  ASSERT_TRUE(faces.InRange((size_t)INT32_MAX + 6));
+}
+GTEST_TEST(prescan, counts) {
+  // Large enough to cross the scan buffer several times
+  const char* path = "test/prescan_counts.obj";
+  FILE* out = fopen(path, "w");
+  fputs("# comment\nvt 0 0\nvn 0 0 1\n", out);
+  for (int i = 0; i < 60000; ++i) {
+    fprintf(out, "v %d.123456 %d.654321 %d.5\n", i, -i, i % 13);
+    if (i > 3 && i % 2)
+      fprintf(out, "f %d/1/1 %d %d  %d\n", i, i - 1, i - 2, i - 3);
+  }
+  fputs("f 1 2\nv 1 2 3", out);
+  fclose(out);
+
+  s21::obj_counts counts;
+  FILE* in = fopen(path, "r");
+  ASSERT_TRUE(s21::Model::ScanStream(in, &counts));
+  ASSERT_EQ(ftell(in), 0);
+  fclose(in);
+
+  s21::Controller controller(false);
+  ASSERT_TRUE(controller.OpenFile(path));
+  remove(path);
+  size_t indices = 0;
+  for (s21::FaceView loop : *controller.GetPolygons()) indices += loop.size();
+  ASSERT_EQ(counts.vertices, controller.GetPoints()->size());
+  ASSERT_EQ(counts.faces, controller.GetPolygons()->size());
+  ASSERT_EQ(counts.indices, indices);
+  ASSERT_EQ(counts.vertices, 60000);
+  ASSERT_LE(controller.GetLoadStats().allocations, 3);
+  ASSERT_EQ(controller.GetLoadStats().expected_bytes,
+            s21::Model::CountBytes(counts));
+}
+
+GTEST_TEST(prescan, lines) {
+  // Records cross the 16 byte blocks the scan classifies at once
+  char text[] =
+      "f -1 +2 x3\tf 4\nv 1 2 3\nvn 0 0 1\nf\n\nf 5  6 7 8 9 10 11 12 13"
+      " 14 15 16\nv\nff 1 2\n f 1 2\nf 1/2/3 4//5 6\n";
+  FILE* in = fmemopen(text, strlen(text), "r");
+  s21::obj_counts counts;
+  ASSERT_TRUE(s21::Model::ScanStream(in, &counts));
+  fclose(in);
+  ASSERT_EQ(counts.vertices, 1);
+  ASSERT_EQ(counts.faces, 3);
+  ASSERT_EQ(counts.indices, 3 + 12 + 3);
+}
+
+GTEST_TEST(prescan, estimate) {
+  // A grid of quads, large enough for the fixed parts not to matter
+  const char* path = "test/prescan_estimate.obj";
+  const int side = 200;
+  FILE* out = fopen(path, "w");
+  for (int y = 0; y <= side; ++y)
+    for (int x = 0; x <= side; ++x) fprintf(out, "v %d %d 0\n", x, y);
+  for (int y = 0; y < side; ++y) {
+    for (int x = 0; x < side; ++x) {
+      int a = y * (side + 1) + x + 1;
+      fprintf(out, "f %d %d %d %d\n", a, a + 1, a + side + 2, a + side + 1);
+    }
+  }
+  fclose(out);
+
+  s21::Controller controller(false);
+  ASSERT_TRUE(controller.OpenFile(path));
+  remove(path);
+  // The model's own points come on top of the published version
+  double used =
+      s21::ModelCache::CountBytes(*controller.GetSnapshot()) +
+      controller.GetPoints()->capacity() * sizeof(s21::vertice);
+  double expected = controller.GetLoadStats().expected_bytes;
+  ASSERT_GT(expected, used * 0.9);
+  ASSERT_LT(expected, used * 1.1);
+}
+
+GTEST_TEST(prescan, memory_limit) {
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  controller.SetMemoryLimit(100);
+  FILE* out = fopen("test/prescan_limit.obj", "w");
+  fputs("v 0 0 0\nv 1 1 1\nv 2 2 2\nv 3 3 3\nf 1 2 3 4\n", out);
+  fclose(out);
+  ASSERT_FALSE(controller.OpenFile("test/prescan_limit.obj"));
+  ASSERT_TRUE(controller.GetLoadStats().refused);
+  ASSERT_GT(controller.GetLoadStats().expected_bytes, 100);
+  ASSERT_EQ(controller.GetPoints()->size(), 8);
+
+  controller.SetMemoryLimit(0);
+  ASSERT_TRUE(controller.OpenFile("test/prescan_limit.obj"));
+  ASSERT_FALSE(controller.GetLoadStats().refused);
+  ASSERT_EQ(controller.GetPoints()->size(), 4);
+  remove("test/prescan_limit.obj");
+}
+
+GTEST_TEST(bricks, header) {
+  const char* path = "test/bricks_header.s21b";
+  ASSERT_TRUE(s21::BrickFile::Build("test/test.obj", path, 2));
+  ASSERT_TRUE(s21::BrickFile::IsBrickFile(path));
+  ASSERT_FALSE(s21::BrickFile::IsBrickFile("test/test.obj"));
+  s21::BrickFile file;
+  ASSERT_TRUE(file.Open(path));
+  remove(path);
+  ASSERT_EQ(file.GetHeader().vertex_count, 8);
+  ASSERT_EQ(file.GetHeader().face_count, 6);
+  ASSERT_EQ(file.GetBrickCount(), 8);
+  ASSERT_NEAR(file.GetHeader().bounds.max.x, 399.307190, 1e-6);
+}
+
+/// Centers of all faces of a model, sorted
+static std::vector<s21::vertice> FaceCentres(s21::Controller* controller) {
+  std::vector<s21::vertice> centres;
+  const std::vector<s21::vertice>& points = *controller->GetPoints();
+  for (s21::FaceView loop : *controller->GetPolygons()) {
+    s21::vertice centre = {0, 0, 0};
+    for (int i : loop) {
+      centre.x += points[i].x / loop.size();
+      centre.y += points[i].y / loop.size();
+      centre.z += points[i].z / loop.size();
+    }
+    centres.push_back(centre);
+  }
+  std::sort(centres.begin(), centres.end(),
+            [](const s21::vertice& a, const s21::vertice& b) {
+              return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+            });
+  return centres;
+}
+
+GTEST_TEST(bricks, paging) {
+  const char* obj = "test/bricks_paging.obj";
+  const char* path = "test/bricks_paging.s21b";
+  FILE* out = fopen(obj, "w");
+  for (int i = 0; i < 20; ++i)
+    for (int j = 0; j < 20; ++j) fprintf(out, "v %d %d %d\n", i, j, i * j % 5);
+  for (int i = 0; i < 19; ++i)
+    for (int j = 0; j < 19; ++j)
+      fprintf(out, "f %d %d %d %d\n", i * 20 + j + 1, i * 20 + j + 2,
+              i * 20 + j + 22, i * 20 + j + 21);
+  fclose(out);
+  ASSERT_TRUE(s21::BrickFile::Build(obj, path, 4));
+
+  s21::Controller expected(false);
+  expected.OpenFile(obj);
+  s21::Controller controller(false);
+  ASSERT_TRUE(controller.OpenFile(path));
+  ASSERT_FALSE(controller.PageBricks());
+  ASSERT_EQ(controller.GetPolygons()->size(), 19 * 19);
+  std::vector<s21::vertice> current = FaceCentres(&controller);
+  std::vector<s21::vertice> reference = FaceCentres(&expected);
+  for (size_t i = 0; i < current.size(); ++i) {
+    ASSERT_NEAR(current[i].x, reference[i].x, 1e-6);
+    ASSERT_NEAR(current[i].y, reference[i].y, 1e-6);
+    ASSERT_NEAR(current[i].z, reference[i].z, 1e-6);
+  }
+
+  // Zooming in leaves only the middle of the model on screen
+  controller.ZoomValue(s21::Constants::MAX_ZOOM);
+  ASSERT_TRUE(controller.PageBricks());
+  size_t visible = controller.GetPolygons()->size();
+  ASSERT_LT(visible, 19 * 19);
+  ASSERT_GT(visible, 0);
+
+  // A small budget holds fewer bricks, and everything they take, the
+  // published version included, stays within it but for fixed parts
+  controller.SetBrickBudget(4096);
+  ASSERT_TRUE(controller.PageBricks());
+  ASSERT_LT(controller.GetPolygons()->size(), visible);
+  ASSERT_GT(controller.GetPolygons()->size(), 0);
+  ASSERT_LE(s21::ModelCache::CountBytes(*controller.GetSnapshot()) +
+                controller.GetPoints()->capacity() * sizeof(s21::vertice),
+            4096 + 1024);
+  remove(obj);
+  remove(path);
+}
+
+/// Writes test.obj with every face using its own copies of its vertices,
+/// moved by up to jitter
+static void WriteUnwelded(const char* path, double jitter) {
+  s21::Controller source(false);
+  source.OpenFile("test/test.obj");
+  FILE* out = fopen(path, "w");
+  int written = 0;
+  for (s21::FaceView loop : *source.GetPolygons()) {
+    for (int index : loop) {
+      s21::vertice point = source.GetPoints()->at(index);
+      double shift = jitter * (written % 3 - 1);
+      fprintf(out, "v %.17g %.17g %.17g\n", point.x + shift, point.y - shift,
+              point.z);
+      ++written;
+    }
+    fputs("f", out);
+    for (size_t i = 0; i < loop.size(); ++i)
+      fprintf(out, " %d", written - (int)loop.size() + (int)i + 1);
+    fputs("\n", out);
+  }
+  fclose(out);
+}
+
+GTEST_TEST(weld, exact) {
+  const char* path = "test/weld_exact.obj";
+  WriteUnwelded(path, 0);
+  s21::Controller plain(false);
+  plain.OpenFile(path);
+  s21::Controller welded(false);
+  welded.SetWelding(0);
+  welded.OpenFile(path);
+  remove(path);
+
+  ASSERT_EQ(plain.GetPoints()->size(), 24);
+  ASSERT_EQ(welded.GetPoints()->size(), 8);
+  ASSERT_EQ(welded.GetLoadStats().welded, 16);
+  ASSERT_EQ(welded.GetParsePosition().offset, -1);
+  std::vector<s21::vertice> current = FaceCentres(&welded);
+  std::vector<s21::vertice> reference = FaceCentres(&plain);
+  ASSERT_EQ(current.size(), reference.size());
+  for (size_t i = 0; i < current.size(); ++i) {
+    ASSERT_DOUBLE_EQ(current[i].x, reference[i].x);
+    ASSERT_DOUBLE_EQ(current[i].y, reference[i].y);
+    ASSERT_DOUBLE_EQ(current[i].z, reference[i].z);
+  }
+}
+
+GTEST_TEST(weld, far_and_non_finite) {
+  // Large coordinates over a small epsilon overflow int64_t cells
+  std::vector<s21::vertice> points = {{NAN, 0, 0},  {NAN, 0, 0},
+                                      {1e300, 0, 0}, {1e300, 0, 0},
+                                      {INFINITY, 1, 1}, {1, 1, 1}};
+  s21::FaceList faces;
+  faces.push_back({0, 1, 2, 3, 4, 5});
+  ASSERT_EQ(s21::WeldVertices(&points, &faces, 1e-9), 1);
+  ASSERT_EQ(points.size(), 5);
+  ASSERT_TRUE(std::isnan(points[0].x));
+  ASSERT_TRUE(std::isnan(points[1].x));
+  ASSERT_EQ(points[2].x, 1e300);
+  ASSERT_TRUE(std::isinf(points[3].x));
+  ASSERT_EQ(faces[0].at(3), 2);
+  ASSERT_EQ(faces[0].at(5), 4);
+}
+
+GTEST_TEST(weld, epsilon) {
+  const char* path = "test/weld_epsilon.obj";
+  WriteUnwelded(path, 1e-7);
+  s21::Controller exact(false);
+  exact.SetWelding(0);
+  exact.OpenFile(path);
+  s21::Controller close(false);
+  close.SetWelding(1e-5);
+  close.OpenFile(path);
+  remove(path);
+
+  ASSERT_GT(exact.GetPoints()->size(), 8);
+  ASSERT_EQ(close.GetPoints()->size(), 8);
+  s21::Controller expected(false);
+  expected.OpenFile("test/test.obj");
+  // Welded points moved a little, so centres are matched by distance
+  std::vector<s21::vertice> reference = FaceCentres(&expected);
+  for (const s21::vertice& centre : FaceCentres(&close)) {
+    bool found = false;
+    for (const s21::vertice& other : reference)
+      found = found || (fabs(centre.x - other.x) < 1e-6 &&
+                        fabs(centre.y - other.y) < 1e-6 &&
+                        fabs(centre.z - other.z) < 1e-6);
+    ASSERT_TRUE(found);
+  }
+}
+
+GTEST_TEST(compact, matches_full) {
+  s21::Controller full(false);
+  full.OpenFile("test/test.obj");
+  s21::Controller compact(false);
+  compact.SetCompact(true);
+  compact.OpenFile("test/test.obj");
+  ASSERT_EQ(compact.GetVertexCount(), 8);
+  ASSERT_EQ(compact.GetPoints()->size(), 0);
+  ASSERT_EQ(*compact.GetPolygons(), *full.GetPolygons());
+  ASSERT_EQ(compact.GetParsePosition().offset, -1);
+
+  for (s21::Controller* controller : {&full, &compact}) {
+    controller->ZoomValue(10);
+    controller->RotateX(30);
+    controller->RotateZ(-45);
+    controller->ShiftYValue(0.25);
+  }
+  s21::geometry_snapshot expected = full.GetSnapshot();
+  s21::geometry_snapshot current = compact.GetSnapshot();
+  ASSERT_EQ(s21::CountPoints(*current), 8);
+  double size = full.GetZoom();
+  for (size_t i = 0; i < 8; ++i) {
+    s21::vertice a = s21::GetPoint(*expected, i);
+    s21::vertice b = s21::GetPoint(*current, i);
+    ASSERT_NEAR(a.x, b.x, size / 65535);
+    ASSERT_NEAR(a.y, b.y, size / 65535);
+    ASSERT_NEAR(a.z, b.z, size / 65535);
+  }
+  ASSERT_LT(s21::ModelCache::CountBytes(*current),
+            s21::ModelCache::CountBytes(*expected));
+}
+
+GTEST_TEST(compact, loader_settings) {
+  s21::Controller controller(false);
+  controller.SetCompact(true);
+  controller.SetWelding(0);
+  std::unique_ptr<s21::Controller> loader = controller.CreateLoader();
+  loader->OpenFile("test/test.obj");
+  ASSERT_EQ(loader->GetVertexCount(), 8);
+  ASSERT_EQ(loader->GetPoints()->size(), 0);
+  controller.ReloadFrom(loader.get());
+  ASSERT_EQ(controller.GetVertexCount(), 8);
+  ASSERT_EQ(controller.GetPoints()->size(), 0);
+}
+
+GTEST_TEST(compact, non_finite) {
+  const char* path = "test/compact_nan.obj";
+  FILE* f = fopen(path, "w");
+  fputs("v nan 0 0\nv 0 0 0\nv 1 1 1\nf 1 2 3\n", f);
+  fclose(f);
+  s21::Controller controller(false);
+  controller.SetCompact(true);
+  controller.OpenFile(path);
+  remove(path);
+
+  const std::vector<uint16_t>& values =
+      controller.GetSnapshot()->packed->values;
+  ASSERT_EQ(values.size(), 9);
+  ASSERT_EQ(values[0], 0);
+}
+
+GTEST_TEST(reorder, acmr) {
+  s21::FaceList faces;
+  faces.push_back({0, 1, 2});
+  ASSERT_DOUBLE_EQ(s21::CountAcmr(faces, 3), 3);
+  faces.push_back({0, 2, 3});
+  ASSERT_DOUBLE_EQ(s21::CountAcmr(faces, 4), 2);
+  ASSERT_DOUBLE_EQ(s21::CountAcmr(s21::FaceList(), 0), 0);
+}
+
+GTEST_TEST(reorder, shuffled_grid) {
+  // A grid of quads written in a random order
+  const char* path = "test/reorder_grid.obj";
+  const int side = 60;
+  std::vector<std::vector<int>> quads;
+  for (int y = 0; y + 1 < side; ++y)
+    for (int x = 0; x + 1 < side; ++x)
+      quads.push_back({y * side + x + 1, y * side + x + 2,
+                       (y + 1) * side + x + 2, (y + 1) * side + x + 1});
+  std::shuffle(quads.begin(), quads.end(), std::mt19937(42));
+  FILE* out = fopen(path, "w");
+  for (int i = 0; i < side * side; ++i)
+    fprintf(out, "v %d %d %d\n", i % side, i / side, i % 7);
+  for (const std::vector<int>& quad : quads)
+    fprintf(out, "f %d %d %d %d\n", quad[0], quad[1], quad[2], quad[3]);
+  fclose(out);
+
+  s21::Controller expected(false);
+  expected.OpenFile(path);
+  s21::Controller controller(false);
+  controller.SetReordering(true);
+  ASSERT_TRUE(controller.OpenFile(path));
+  remove(path);
+
+  s21::load_stats stats = controller.GetLoadStats();
+  ASSERT_DOUBLE_EQ(stats.acmr_before,
+                   s21::CountAcmr(*expected.GetPolygons(), side * side));
+  ASSERT_LT(stats.acmr_after, stats.acmr_before * 0.75);
+  ASSERT_EQ(controller.GetParsePosition().offset, -1);
+  ASSERT_EQ(controller.GetPoints()->size(), side * side);
+  ASSERT_EQ(controller.GetPolygons()->size(), quads.size());
+
+  // Vertices are numbered in the order faces first use them
+  int64_t next = 0;
+  for (s21::FaceView loop : *controller.GetPolygons()) {
+    for (int64_t index : loop) {
+      ASSERT_LE(index, next);
+      if (index == next) ++next;
+    }
+  }
+
+  std::vector<s21::vertice> current = FaceCentres(&controller);
+  std::vector<s21::vertice> reference = FaceCentres(&expected);
+  for (size_t i = 0; i < current.size(); ++i) {
+    ASSERT_DOUBLE_EQ(current[i].x, reference[i].x);
+    ASSERT_DOUBLE_EQ(current[i].y, reference[i].y);
+    ASSERT_DOUBLE_EQ(current[i].z, reference[i].z);
+  }
+}
+
+GTEST_TEST(strips, line_strips) {
+  s21::FaceList faces;
+  faces.push_back({0, 1, 2, 3});
+  faces.push_back({4, -1, 1});
+  faces.push_back({2});
+  faces.push_back({9, 0, 9});
+  std::shared_ptr<const s21::index_stream> stream =
+      s21::BuildLineStrips(faces, 5);
+  ASSERT_EQ(stream->width, 2);
+  std::vector<int64_t> indices;
+  for (size_t i = 0; i < stream->count; ++i)
+    indices.push_back(s21::ReadIndex(stream->indices.data(), 2, i));
+  // The restart index reads as -1
+  ASSERT_EQ(indices, std::vector<int64_t>({0, 1, 2, 3, 0, -1, 4, 1, -1, 2,
+                                           -1, 0}));
+
+  faces.AddIndex(70000);
+  faces.CloseFace();
+  ASSERT_EQ(s21::BuildLineStrips(faces, 5)->width, 4);
+  ASSERT_EQ(s21::RestartIndex(4), UINT32_MAX);
+  faces.AddIndex(5000000000LL);
+  faces.CloseFace();
+  ASSERT_EQ(s21::BuildLineStrips(faces, 5), nullptr);
+}
+
+GTEST_TEST(strips, shared_by_versions) {
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  std::shared_ptr<const s21::index_stream> strips =
+      controller.GetSnapshot()->line_strips;
+  // Six closed quads and five restart indices between them
+  ASSERT_EQ(strips->count, 6 * 5 + 5);
+
+  controller.RotateX(30);
+  controller.ZoomValue(10);
+  ASSERT_EQ(controller.GetSnapshot()->line_strips, strips);
+
+  controller.OpenFile("test/test.obj");
+  ASSERT_NE(controller.GetSnapshot()->line_strips, strips);
+  ASSERT_EQ(controller.GetSnapshot()->line_strips->indices, strips->indices);
+}
+
+/// @brief Sums the areas of triangles, the ones turned against the normal
+/// are subtracted
+static double SumAreas(const s21::geometry& model,
+                       const s21::triangle_list& triangles,
+                       s21::vertice normal) {
+  double sum = 0;
+  for (size_t i = 0; i < triangles.indices.count; i += 3) {
+    s21::vertice p[3];
+    for (int k = 0; k < 3; ++k)
+      p[k] = model.points[s21::ReadIndex(triangles.indices.indices.data(),
+                                         triangles.indices.width, i + k)];
+    s21::vertice u = {p[1].x - p[0].x, p[1].y - p[0].y, p[1].z - p[0].z};
+    s21::vertice v = {p[2].x - p[0].x, p[2].y - p[0].y, p[2].z - p[0].z};
+    s21::vertice cross = {u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z,
+                          u.x * v.y - u.y * v.x};
+    sum += (cross.x * normal.x + cross.y * normal.y + cross.z * normal.z) / 2;
+  }
+  return sum;
+}
+
+GTEST_TEST(triangulate, concave) {
+  // A star with 5 spikes in a tilted plane, and a comb of 4 teeth
+  s21::geometry model;
+  std::shared_ptr<s21::FaceList> faces = std::make_shared<s21::FaceList>();
+  double star_area = 0;
+  for (int i = 0; i < 10; ++i) {
+    double angle = M_PI * i / 5, radius = i % 2 ? 0.4 : 1;
+    double x = radius * cos(angle), y = radius * sin(angle);
+    model.points.push_back({x, y * 0.6, y * 0.8});
+    faces->AddIndex(i);
+  }
+  faces->CloseFace();
+  for (int i = 0; i < 10; ++i) {
+    double a = M_PI * i / 5, b = M_PI * (i + 1) / 5;
+    double ra = i % 2 ? 0.4 : 1, rb = i % 2 ? 1 : 0.4;
+    star_area += ra * rb * sin(b - a) / 2;
+  }
+  std::vector<std::pair<double, double>> comb = {
+      {0, 0}, {8, 0}, {8, 3}, {7, 3}, {7, 1}, {5, 1}, {5, 3}, {4, 3},
+      {4, 1}, {2, 1}, {2, 3}, {1, 3}, {1, 1}, {0, 1}};
+  for (const std::pair<double, double>& point : comb) {
+    faces->AddIndex(model.points.size());
+    model.points.push_back({point.first, 5, point.second});
+  }
+  faces->CloseFace();
+  faces->push_back({0, 1});
+  model.polygons = faces;
+
+  std::shared_ptr<const s21::triangle_list> triangles = s21::Triangulate(model);
+  ASSERT_EQ(triangles->faces.size(), 8 + 12);
+  ASSERT_EQ(triangles->indices.count, 3 * (8 + 12));
+
+  s21::triangle_list star = *triangles, teeth = *triangles;
+  star.indices.count = 8 * 3;
+  ASSERT_NEAR(SumAreas(model, star, {0, -0.8, 0.6}), star_area, 1e-9);
+  for (size_t i = 0; i < 8; ++i) ASSERT_EQ(triangles->faces[i], 0);
+  // Every triangle of the comb turns the same way as the comb
+  double comb_area = 8 + 3 * 2;
+  const s21::SharedArray<uint8_t>& all = triangles->indices.indices;
+  teeth.indices.indices.clear();
+  teeth.indices.indices.append(all.data() + 8 * 3 * 2, all.size() - 8 * 3 * 2);
+  teeth.indices.count = 12 * 3;
+  ASSERT_NEAR(SumAreas(model, teeth, {0, -1, 0}), comb_area, 1e-9);
+  for (size_t i = 0; i < 12; ++i) {
+    s21::triangle_list one = teeth;
+    one.indices.indices.clear();
+    one.indices.indices.append(teeth.indices.indices.data() + i * 3 * 2,
+                               3 * 2);
+    one.indices.count = 3;
+    ASSERT_GT(SumAreas(model, one, {0, -1, 0}), 0);
+  }
+}
+
+GTEST_TEST(triangulate, parallel) {
+  s21::geometry model;
+  std::shared_ptr<s21::FaceList> faces = std::make_shared<s21::FaceList>();
+  for (int i = 0; i < 20000; ++i) {
+    size_t base = model.points.size();
+    model.points.push_back({(double)i, 0, 0});
+    model.points.push_back({i + 1.0, 0, 0});
+    model.points.push_back({i + 0.5, 0.2, 0});
+    model.points.push_back({i + 1.0, 1, 0});
+    model.points.push_back({(double)i, 1, 0});
+    faces->push_back({(int)base, (int)base + 1, (int)base + 2, (int)base + 3,
+                      (int)base + 4});
+  }
+  model.polygons = faces;
+  std::shared_ptr<const s21::triangle_list> one = s21::Triangulate(model, 1);
+  std::shared_ptr<const s21::triangle_list> many = s21::Triangulate(model, 4);
+  ASSERT_EQ(one->indices.count, 20000 * 3 * 3);
+  ASSERT_EQ(one->indices.indices, many->indices.indices);
+  ASSERT_EQ(one->faces, many->faces);
+  ASSERT_EQ(many->faces.back(), 19999);
+}
+
+GTEST_TEST(triangulate, cached_at_load) {
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  std::shared_ptr<const s21::triangle_list> triangles =
+      controller.GetSnapshot()->triangles;
+  ASSERT_EQ(triangles->faces.size(), 12);
+  ASSERT_EQ(triangles->faces[2], 1);
+  controller.RotateY(40);
+  controller.ZoomValue(3);
+  ASSERT_EQ(controller.GetSnapshot()->triangles, triangles);
+}
+
+GTEST_TEST(triangulate, outline) {
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  std::shared_ptr<const s21::triangle_list> triangles =
+      controller.GetSnapshot()->triangles;
+  ASSERT_EQ(triangles->edges.size(), triangles->faces.size());
+  // Every quad is cut once, so both halves have two of its edges, and the
+  // edge they share, opposite the corner they don't share, is left out
+  std::vector<int> outlined(6, 0);
+  for (size_t i = 0; i < triangles->edges.size(); ++i) {
+    uint8_t edges = triangles->edges[i];
+    ASSERT_LT(edges, 8);
+    outlined[triangles->faces[i]] += (edges & 1) + (edges >> 1 & 1) +
+                                     (edges >> 2 & 1);
+  }
+  for (int count : outlined) ASSERT_EQ(count, 4);
+}
+
+GTEST_TEST(normals, cube) {
+  s21::Controller controller(false);
+  controller.OpenFile("test/test.obj");
+  std::shared_ptr<const s21::normal_list> normals =
+      controller.GetSnapshot()->normals;
+  ASSERT_EQ(normals->faces.size(), 6);
+  ASSERT_EQ(normals->vertices.size(), 8);
+  // The top face goes counterclockwise seen from above
+  ASSERT_NEAR(normals->faces[0].x, 0, 1e-9);
+  ASSERT_NEAR(normals->faces[0].y, 1, 1e-9);
+  ASSERT_NEAR(normals->faces[0].z, 0, 1e-9);
+  double third = 1 / sqrt(3);
+  ASSERT_NEAR(normals->vertices[0].x, third, 1e-9);
+  ASSERT_NEAR(normals->vertices[0].y, third, 1e-9);
+  ASSERT_NEAR(normals->vertices[0].z, -third, 1e-9);
+
+  // Turning the model turns the normals it is drawn with only
+  controller.RotateX(90);
+  s21::geometry_snapshot snapshot = controller.GetSnapshot();
+  ASSERT_EQ(snapshot->normals, normals);
+  const double* m = snapshot->normal_rotation;
+  s21::vertice up = normals->faces[0];
+  ASSERT_NEAR(fabs(m[0] * up.x + m[1] * up.y + m[2] * up.z) +
+                  fabs(m[3] * up.x + m[4] * up.y + m[5] * up.z) +
+                  fabs(m[6] * up.x + m[7] * up.y + m[8] * up.z),
+              1, 1e-9);
+  ASSERT_NEAR(m[3] * up.x + m[4] * up.y + m[5] * up.z, 0, 1e-9);
+}
+
+GTEST_TEST(normals, vn_records) {
+  const char* path = "test/normals_vn.obj";
+  FILE* out = fopen(path, "w");
+  fputs("v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvn 0 0 -2\n", out);
+  fputs("f 1//1 2//1 3\nf 2 4 3\n", out);
+  fclose(out);
+  s21::Controller controller(false);
+  ASSERT_TRUE(controller.OpenFile(path));
+  remove(path);
+  std::shared_ptr<const s21::normal_list> normals =
+      controller.GetSnapshot()->normals;
+  // Faces keep the winding, vertices named in vn records keep the file's
+  // normals, made unit length
+  ASSERT_NEAR(normals->faces[1].z, 1, 1e-9);
+  ASSERT_NEAR(normals->vertices[0].z, -1, 1e-9);
+  ASSERT_NEAR(normals->vertices[1].z, -1, 1e-9);
+  ASSERT_NEAR(normals->vertices[2].z, 1, 1e-9);
+  ASSERT_NEAR(normals->vertices[3].z, 1, 1e-9);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();